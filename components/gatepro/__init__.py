@@ -0,0 +1,24 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import CONF_ID
+
+MULTI_CONF = True
+
+gatepro_ns = cg.esphome_ns.namespace("gatepro")
+GateProBus = gatepro_ns.class_("GateProBus", cg.Component)
+
+CONF_GATEPRO_BUS_ID = "gatepro_bus_id"
+CONF_POLL_GAP = "poll_gap"                  # Minimum time between two status polls on the bus
+
+# Optional hub coordinating several gates on one node, see GateProBus
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(GateProBus),
+        cv.Optional(CONF_POLL_GAP, default="250ms"): cv.positive_time_period_milliseconds,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    cg.add(var.set_poll_gap(config[CONF_POLL_GAP]))
@@ -2,16 +2,32 @@ import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import uart, sensor, cover, button, number, text_sensor, switch
 from esphome.const import CONF_ID, ICON_EMPTY, UNIT_EMPTY
+from . import gatepro_ns, GateProBus, CONF_GATEPRO_BUS_ID
 
 DEPENDENCIES = ["uart", "cover", "button"]
 
-gatepro_ns = cg.esphome_ns.namespace("gatepro")
 GatePro = gatepro_ns.class_(
     "GatePro", cover.Cover, cg.PollingComponent, uart.UARTDevice
 )
+GateProCounter = gatepro_ns.enum("GateProCounter")
+GateProLatency = gatepro_ns.enum("GateProLatency")
 
 CONF_OPERATIONAL_SPEED = "operational_speed"
 CONF_SOURCE = "source"
+CONF_EVENT_SOURCE = "event_source"         # src= code of this gate's motor events on a shared bus
+CONF_INTER_FRAME_GAP = "inter_frame_gap"   # Idle time on the bus between frames
+CONF_MOVING_POLL_INTERVAL = "moving_poll_interval"  # Status polling while the gate moves
+CONF_IDLE_POLL_INTERVAL = "idle_poll_interval"      # Status polling while the gate is idle
+CONF_PARAM_COMMIT_WINDOW = "param_commit_window"    # Batching of parameter changes
+CONF_PUBLISH_DELTA = "publish_delta"                # Smallest position change published
+CONF_MOVING_PUBLISH_INTERVAL = "moving_publish_interval"  # Publish rate limit while moving
+CONF_HEARTBEAT_INTERVAL = "heartbeat_interval"      # Re-publish an unchanged idle state
+CONF_CAPTURE_SIZE = "capture_size"                  # Raw UART capture ring, off by default
+CONF_TX_QUEUE_SIZE = "tx_queue_size"                # Requests waiting to be sent
+CONF_RX_BUFFER_SIZE = "rx_buffer_size"              # Bytes of received frames waiting to be dispatched
+CONF_LOOP_BUDGET = "loop_budget"                    # CPU time per loop() for received frames
+CONF_STATE_CONFIRMATIONS = "state_confirmations"    # RS patterns that settle the state without an event
+CONF_STATE_TIMEOUT = "state_timeout"                # Disagreeing RS patterns are ignored this long after an event
 
 # Basic operation button configurations
 CONF_OPEN_BTN = "open"                      # Manual open button
@@ -22,6 +38,8 @@ CONF_STOP_BTN = "stop"                      # Manual stop button
 CONF_LEARN = "set_learn"                    # Auto learn function
 CONF_PARAMS_OD = "get_params"               # Read parameters on demand
 CONF_REMOTE_LEARN = "remote_learn"          # Remote control learn
+CONF_DUMP_TRACE = "dump_trace"              # Log the protocol trace ring
+CONF_DUMP_CAPTURE = "dump_capture"          # Log the UART capture as hex
 
 # Number slider configurations (parameter groups)
 CONF_SPEED_SLIDER = "set_speed"             # group 3 - Operation speed
@@ -35,6 +53,33 @@ CONF_FORCE_DETECTION = "set_force_detection" # group 10 - Force detection reacti
 # Text sensor configurations
 CONF_DEVINFO = "txt_devinfo"                # Device information
 CONF_LEARN_STATUS = "txt_learn_status"      # Learn status information
+CONF_STATUS = "txt_status"                  # Raw status (ACK RS) bytes
+
+# Diagnostic sensor configurations
+CONF_FRAMES_IN = "frames_in"                # Frames received
+CONF_FRAMES_OUT = "frames_out"              # Frames sent
+CONF_PARSE_FAILURES = "parse_failures"      # Malformed frames
+CONF_QUEUE_DROPS = "queue_drops"            # Commands dropped by a full TX queue
+CONF_RX_OVERFLOWS = "rx_overflows"          # RX buffer cleared without a delimiter
+CONF_LOOP_OVERRUNS = "loop_overruns"        # loop() took longer than loop_budget
+CONF_RX_BACKLOG = "rx_backlog"              # Peak bytes left waiting for the next loop(), per update_interval
+CONF_COMMAND_LATENCY = "command_latency"    # p95 ms from queueing to the UART write
+CONF_ACK_LATENCY = "ack_latency"            # p95 ms from the first write to its ACK
+CONF_MOTION_LATENCY = "motion_latency"      # p95 ms from OPEN/CLOSE to the motor event
+
+COUNTER_SENSORS = {
+    CONF_FRAMES_IN: GateProCounter.COUNTER_FRAMES_IN,
+    CONF_FRAMES_OUT: GateProCounter.COUNTER_FRAMES_OUT,
+    CONF_PARSE_FAILURES: GateProCounter.COUNTER_PARSE_FAILURES,
+    CONF_QUEUE_DROPS: GateProCounter.COUNTER_QUEUE_DROPS,
+    CONF_RX_OVERFLOWS: GateProCounter.COUNTER_RX_OVERFLOWS,
+    CONF_LOOP_OVERRUNS: GateProCounter.COUNTER_LOOP_OVERRUNS,
+}
+LATENCY_SENSORS = {
+    CONF_COMMAND_LATENCY: GateProLatency.LATENCY_COMMAND,
+    CONF_ACK_LATENCY: GateProLatency.LATENCY_ACK,
+    CONF_MOTION_LATENCY: GateProLatency.LATENCY_MOTION,
+}
 
 # Switch configurations (parameter groups)
 CONF_PERMALOCK = "sw_permalock"             # group 15 - Permanent lock
@@ -50,6 +95,21 @@ CONFIG_SCHEMA = cover.cover_schema(GatePro).extend(
     {
         cv.GenerateID(): cv.declare_id(GatePro),
         cv.Optional(CONF_SOURCE, default="P00287D7"): cv.string,
+        cv.Optional(CONF_GATEPRO_BUS_ID): cv.use_id(GateProBus),
+        cv.Optional(CONF_EVENT_SOURCE): cv.string,
+        cv.Optional(CONF_INTER_FRAME_GAP, default="50ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MOVING_POLL_INTERVAL, default="500ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_IDLE_POLL_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_PARAM_COMMIT_WINDOW, default="250ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_PUBLISH_DELTA, default=0.01): cv.percentage,
+        cv.Optional(CONF_MOVING_PUBLISH_INTERVAL, default="500ms"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_HEARTBEAT_INTERVAL): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_CAPTURE_SIZE): cv.int_range(min=256, max=65536),
+        cv.Optional(CONF_TX_QUEUE_SIZE, default=10): cv.int_range(min=3, max=64),
+        cv.Optional(CONF_RX_BUFFER_SIZE, default=512): cv.int_range(min=64, max=8192),
+        cv.Optional(CONF_LOOP_BUDGET, default="2ms"): cv.positive_time_period_microseconds,
+        cv.Optional(CONF_STATE_CONFIRMATIONS, default=2): cv.int_range(min=1, max=10),
+        cv.Optional(CONF_STATE_TIMEOUT, default="2s"): cv.positive_time_period_milliseconds,
         
         # Basic operation button components
         cv.Optional(CONF_OPEN_BTN): cv.use_id(button.Button),                # Manual open button
@@ -60,6 +120,8 @@ CONFIG_SCHEMA = cover.cover_schema(GatePro).extend(
         cv.Optional(CONF_LEARN): cv.use_id(button.Button),                    # Auto learn function
         cv.Optional(CONF_PARAMS_OD): cv.use_id(button.Button),               # Read parameters on demand
         cv.Optional(CONF_REMOTE_LEARN): cv.use_id(button.Button),            # Remote control learn
+        cv.Optional(CONF_DUMP_TRACE): cv.use_id(button.Button),              # Log the protocol trace ring
+        cv.Optional(CONF_DUMP_CAPTURE): cv.use_id(button.Button),            # Log the UART capture as hex
         
         # Number slider components (parameter groups)
         cv.Optional(CONF_SPEED_SLIDER): cv.use_id(number.Number),            # group 3 - Operation speed
@@ -73,6 +135,12 @@ CONFIG_SCHEMA = cover.cover_schema(GatePro).extend(
         # Text sensor components
         cv.Optional(CONF_DEVINFO): cv.use_id(text_sensor.TextSensor),        # Device information
         cv.Optional(CONF_LEARN_STATUS): cv.use_id(text_sensor.TextSensor),   # Learn status information
+        cv.Optional(CONF_STATUS): cv.use_id(text_sensor.TextSensor),         # Raw status (ACK RS) bytes
+
+        # Diagnostic sensor components
+        **{cv.Optional(key): cv.use_id(sensor.Sensor) for key in COUNTER_SENSORS},
+        **{cv.Optional(key): cv.use_id(sensor.Sensor) for key in LATENCY_SENSORS},
+        cv.Optional(CONF_RX_BACKLOG): cv.use_id(sensor.Sensor),
         
         # Switch components (parameter groups)
         cv.Optional(CONF_PERMALOCK): cv.use_id(switch.Switch),               # group 15 - Permanent lock
@@ -88,6 +156,26 @@ async def to_code(config):
     
     if CONF_SOURCE in config:
         cg.add(var.set_source(config[CONF_SOURCE]))
+    if CONF_GATEPRO_BUS_ID in config:
+        bus = await cg.get_variable(config[CONF_GATEPRO_BUS_ID])
+        cg.add(var.set_bus(bus))
+    if CONF_EVENT_SOURCE in config:
+        cg.add(var.set_event_source(config[CONF_EVENT_SOURCE]))
+    cg.add(var.set_inter_frame_gap(config[CONF_INTER_FRAME_GAP]))
+    cg.add(var.set_moving_poll_interval(config[CONF_MOVING_POLL_INTERVAL]))
+    cg.add(var.set_idle_poll_interval(config[CONF_IDLE_POLL_INTERVAL]))
+    cg.add(var.set_param_commit_window(config[CONF_PARAM_COMMIT_WINDOW]))
+    cg.add(var.set_publish_delta(config[CONF_PUBLISH_DELTA]))
+    cg.add(var.set_moving_publish_interval(config[CONF_MOVING_PUBLISH_INTERVAL]))
+    if CONF_HEARTBEAT_INTERVAL in config:
+        cg.add(var.set_heartbeat_interval(config[CONF_HEARTBEAT_INTERVAL]))
+    cg.add(var.set_tx_queue_size(config[CONF_TX_QUEUE_SIZE]))
+    cg.add(var.set_rx_buffer_size(config[CONF_RX_BUFFER_SIZE]))
+    cg.add(var.set_loop_budget(config[CONF_LOOP_BUDGET]))
+    cg.add(var.set_state_confirmations(config[CONF_STATE_CONFIRMATIONS]))
+    cg.add(var.set_state_timeout(config[CONF_STATE_TIMEOUT]))
+    if CONF_CAPTURE_SIZE in config:
+        cg.add(var.set_capture_size(config[CONF_CAPTURE_SIZE]))
 
     # Basic operation button components
     if CONF_OPEN_BTN in config:                                             # Manual open button
@@ -110,6 +198,12 @@ async def to_code(config):
     if CONF_REMOTE_LEARN in config:                                         # Remote control learn
         btn = await cg.get_variable(config[CONF_REMOTE_LEARN])
         cg.add(var.set_btn_remote_learn(btn))
+    if CONF_DUMP_TRACE in config:                                           # Log the protocol trace ring
+        btn = await cg.get_variable(config[CONF_DUMP_TRACE])
+        cg.add(var.set_btn_dump_trace(btn))
+    if CONF_DUMP_CAPTURE in config:                                         # Log the UART capture as hex
+        btn = await cg.get_variable(config[CONF_DUMP_CAPTURE])
+        cg.add(var.set_btn_dump_capture(btn))
     
     # Number slider components (parameter groups)
     if CONF_SPEED_SLIDER in config:                                         # group 3 - Operation speed
@@ -141,6 +235,22 @@ async def to_code(config):
     if CONF_LEARN_STATUS in config:                                         # Learn status information
         txt = await cg.get_variable(config[CONF_LEARN_STATUS])
         cg.add(var.set_txt_learn_status(txt))
+    if CONF_STATUS in config:                                               # Raw status (ACK RS) bytes
+        txt = await cg.get_variable(config[CONF_STATUS])
+        cg.add(var.set_txt_status(txt))
+
+    # Diagnostic sensor components
+    for key, counter in COUNTER_SENSORS.items():
+        if key in config:
+            sens = await cg.get_variable(config[key])
+            cg.add(var.set_counter_sensor(counter, sens))
+    for key, latency in LATENCY_SENSORS.items():
+        if key in config:
+            sens = await cg.get_variable(config[key])
+            cg.add(var.set_latency_sensor(latency, sens))
+    if CONF_RX_BACKLOG in config:
+        sens = await cg.get_variable(config[CONF_RX_BACKLOG])
+        cg.add(var.set_rx_backlog_sensor(sens))
     
     # Switch components (parameter groups)
     if CONF_PERMALOCK in config:                                            # group 15 - Permanent lock
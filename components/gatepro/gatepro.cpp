@@ -1,7 +1,8 @@
 #include "esphome/core/log.h"
 #include "gatepro.h"
+#include "gatepro_bus.h"
+#include <cstring>
 #include <vector>
-#include <functional>
 
 namespace esphome {
 namespace gatepro {
@@ -9,306 +10,667 @@ namespace gatepro {
 ////////////////////////////////////
 static const char* TAG = "gatepro";
 
+// Initial acknowledgement timeout per GateProAck
+static const uint32_t ACK_TIMEOUTS[GATEPRO_ACK_COUNT] = {
+   0,      // GATEPRO_ACK_NONE
+   500,    // GATEPRO_ACK_RS
+   1000,   // GATEPRO_ACK_RP
+   1000,   // GATEPRO_ACK_WP
+   1000,   // GATEPRO_ACK_DEVINFO
+   1000,   // GATEPRO_ACK_LEARN_STATUS
+};
+
+static GateProAck expected_ack(GateProCmd cmd) {
+   switch (cmd) {
+      case GATEPRO_CMD_READ_STATUS: return GATEPRO_ACK_RS;
+      case GATEPRO_CMD_READ_PARAMS: return GATEPRO_ACK_RP;
+      case GATEPRO_CMD_WRITE_PARAMS: return GATEPRO_ACK_WP;
+      case GATEPRO_CMD_DEVINFO: return GATEPRO_ACK_DEVINFO;
+      case GATEPRO_CMD_READ_LEARN_STATUS: return GATEPRO_ACK_LEARN_STATUS;
+      default: return GATEPRO_ACK_NONE;
+   }
+}
+
 ////////////////////////////////////////////
 // Helper / misc functions
 ////////////////////////////////////////////
-std::string GatePro::get_command_string(GateProCmd cmd) {
-   static char cmd_buffer[100];
-   
-   auto it = GateProCmdTemplates.find(cmd);
-   if (it == GateProCmdTemplates.end()) {
+// Fixed command frames, indexed by GateProCmd, the source follows the prefix.
+// The WP frame carries the parameter values instead, see GateProParams::encode().
+static constexpr std::string_view COMMAND_PREFIXES[] = {
+   "FULL OPEN;src=",           // GATEPRO_CMD_OPEN
+   "FULL CLOSE;src=",          // GATEPRO_CMD_CLOSE
+   "STOP;src=",                // GATEPRO_CMD_STOP
+   "RS;src=",                  // GATEPRO_CMD_READ_STATUS
+   "RP,1:;src=",               // GATEPRO_CMD_READ_PARAMS
+   {},                         // GATEPRO_CMD_WRITE_PARAMS
+   "AUTO LEARN;src=",          // GATEPRO_CMD_LEARN
+   "READ DEVINFO;src=",        // GATEPRO_CMD_DEVINFO
+   "READ LEARN STATUS;src=",   // GATEPRO_CMD_READ_LEARN_STATUS
+   "REMOTE LEARN;src=",        // GATEPRO_CMD_REMOTE_LEARN
+   "CLEAR REMOTE LEARN;src=",  // GATEPRO_CMD_CLEAR_REMOTE_LEARN
+   "RESTORE;src=",             // GATEPRO_CMD_RESTORE
+   "PED OPEN;src=",            // GATEPRO_CMD_PED_OPEN
+   "READ FUNCTION;src=",       // GATEPRO_CMD_READ_FUNCTION
+};
+static_assert(sizeof(COMMAND_PREFIXES) / sizeof(COMMAND_PREFIXES[0]) == GATEPRO_CMD_COUNT,
+              "COMMAND_PREFIXES needs one entry per GateProCmd");
+static_assert(COMMAND_PREFIXES[GATEPRO_CMD_STOP] == "STOP;src=" && COMMAND_PREFIXES[GATEPRO_CMD_WRITE_PARAMS].empty() &&
+                  COMMAND_PREFIXES[GATEPRO_CMD_READ_FUNCTION] == "READ FUNCTION;src=",
+              "COMMAND_PREFIXES is out of order with GateProCmd");
+
+void GatePro::build_command_frames_() {
+   static constexpr std::string_view DELIMITER(TX_DELIMITER);
+   size_t total = 0;
+   for (auto prefix : COMMAND_PREFIXES) {
+      if (!prefix.empty()) {
+         total += prefix.size() + this->source_.size() + DELIMITER.size();
+      }
+   }
+   this->command_frames_.reset(new char[total]);
+   char *out = this->command_frames_.get();
+   for (uint8_t i = 0; i < GATEPRO_CMD_COUNT; i++) {
+      this->command_frame_at_[i] = out - this->command_frames_.get();
+      if (COMMAND_PREFIXES[i].empty()) {
+         continue;
+      }
+      for (auto part : {COMMAND_PREFIXES[i], std::string_view(this->source_), DELIMITER}) {
+         memcpy(out, part.data(), part.size());
+         out += part.size();
+      }
+   }
+   this->command_frame_at_[GATEPRO_CMD_COUNT] = total;
+}
+
+std::string_view GatePro::command_frame_(GateProCmd cmd) const {
+   if (cmd >= GATEPRO_CMD_COUNT || !this->command_frames_) {
+      return {};
+   }
+   uint16_t at = this->command_frame_at_[cmd];
+   return std::string_view(this->command_frames_.get() + at, this->command_frame_at_[cmd + 1] - at);
+}
+
+std::string_view GatePro::get_command_string(GateProCmd cmd) const {
+   std::string_view frame = this->command_frame_(cmd);
+   return frame.substr(0, frame.empty() ? 0 : frame.size() - (sizeof(TX_DELIMITER) - 1));
+}
+
+size_t GatePro::format_request_(const GateProRequest &request, char *buf, size_t len) const {
+   // the WP frame carries the values instead of the source
+   if (request.cmd == GATEPRO_CMD_WRITE_PARAMS) {
+      return request.params.encode(buf, len);
+   }
+   std::string_view frame = this->get_command_string(request.cmd);
+   if (frame.size() >= len) {
+      return 0;
+   }
+   memcpy(buf, frame.data(), frame.size());
+   return frame.size();
+}
+
+const char *GatePro::request_text_(const GateProRequest &request) {
+   size_t len = this->format_request_(request, this->request_text_buf_, sizeof(this->request_text_buf_));
+   this->request_text_buf_[len] = '\0';
+   return this->request_text_buf_;
+}
+
+bool GatePro::queue_gatepro_cmd(GateProCmd cmd) {
+   if (cmd >= GATEPRO_CMD_COUNT || cmd == GATEPRO_CMD_WRITE_PARAMS) {
       ESP_LOGE(TAG, "Unknown command type: %d", cmd);
-      return "";
+      return false;
    }
-   
-   const char* template_str = it->second;
-   
-   // Special case for WRITE_PARAMS - no source parameter needed
-   if (cmd == GATEPRO_CMD_WRITE_PARAMS) {
-      return std::string(template_str);
+   if (!this->tx_queue.push({cmd, millis()})) {
+      return false;
    }
-   
-   // Format with source parameter
-   snprintf(cmd_buffer, sizeof(cmd_buffer), template_str, this->source_.c_str());
-   return std::string(cmd_buffer);
+   const char *frame = this->request_text_({cmd});
+   this->trace_(TRACE_QUEUED, this->tx_queue.size(), frame);
+   ESP_LOGV(TAG, "Queued command: %s (queue size: %zu)", frame, this->tx_queue.size());
+   return true;
 }
 
-void GatePro::queue_gatepro_cmd(GateProCmd cmd) {
-   std::string cmd_str = this->get_command_string(cmd);
-   if (!cmd_str.empty()) {
-      // Prevent queue overflow
-      if (this->tx_queue.size() >= MAX_QUEUE_SIZE) {
-         ESP_LOGW(TAG, "TX queue full, dropping oldest command");
-         this->tx_queue.pop();
+////////////////////////////////////////////
+// Status decoding
+////////////////////////////////////////////
+static int8_t hex_value(char c) {
+   if (c >= '0' && c <= '9') return c - '0';
+   if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+   if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+   return -1;
+}
+
+bool GateProStatus::decode(std::string_view frame, GateProStatus *status) {
+   // ACK RS:00,80,C4,C6,3E,16,FF,FF,FF
+   //        ^-7, then one two-digit hex byte every third character
+   static const size_t FIRST_BYTE = 7;
+   if (frame.size() < FIRST_BYTE || frame[FIRST_BYTE - 1] != ':') {
+      return false;
+   }
+   status->count = 0;
+   size_t pos = FIRST_BYTE;
+   while (status->count < SIZE && pos + 2 <= frame.size()) {
+      int8_t hi = hex_value(frame[pos]);
+      int8_t lo = hex_value(frame[pos + 1]);
+      if (hi < 0 || lo < 0) {
+         return false;
+      }
+      status->bytes[status->count++] = (hi << 4) | lo;
+      pos += 2;
+      if (pos == frame.size()) {
+         break;
       }
-      this->tx_queue.push(cmd_str);
-      ESP_LOGD(TAG, "Queued command: %s (queue size: %zu)", cmd_str.c_str(), this->tx_queue.size());
+      if (frame[pos] != ',') {
+         return false;
+      }
+      pos++;
    }
+   // the position lives in byte 3
+   return status->count > 3;
+}
+
+uint8_t GateProStatus::position_percent() const {
+   // bit 7 is a flag, the low bits carry the percentage
+   return std::min<uint8_t>(this->bytes[3] & 0x7F, 100);
 }
 
+////////////////////////////////////////////
+// Command queue
+////////////////////////////////////////////
+GateProPriority GateProCommandQueue::priority(GateProCmd cmd) {
+   switch (cmd) {
+      case GATEPRO_CMD_STOP:
+         return GATEPRO_PRIORITY_STOP;
+      case GATEPRO_CMD_OPEN:
+      case GATEPRO_CMD_CLOSE:
+      case GATEPRO_CMD_PED_OPEN:
+         return GATEPRO_PRIORITY_MOTION;
+      case GATEPRO_CMD_READ_STATUS:
+      case GATEPRO_CMD_READ_PARAMS:
+      case GATEPRO_CMD_DEVINFO:
+      case GATEPRO_CMD_READ_LEARN_STATUS:
+      case GATEPRO_CMD_READ_FUNCTION:
+         return GATEPRO_PRIORITY_READ;
+      default:
+         return GATEPRO_PRIORITY_CONFIG;
+   }
+}
+
+void GateProCommandQueue::init(size_t capacity) {
+   this->capacity_ = std::max(capacity, MIN_CAPACITY);
+   this->entries_.reset(new GateProRequest[this->capacity_]);
+   this->size_ = 0;
+}
+
+bool GateProCommandQueue::push(const GateProRequest &request) {
+   GateProPriority prio = priority(request.cmd);
+
+   switch (prio) {
+      case GATEPRO_PRIORITY_STOP:
+      case GATEPRO_PRIORITY_MOTION:
+         // a STOP or a newer motion request supersedes queued motion commands
+         for (size_t i = this->size_; i-- > 0;) {
+            if (priority(this->entries_[i].cmd) == GATEPRO_PRIORITY_MOTION) {
+               this->erase(i);
+            }
+         }
+         if (prio == GATEPRO_PRIORITY_STOP && this->find_(GATEPRO_CMD_STOP) >= 0) {
+            return true;
+         }
+         break;
+      default: {
+         // reads are idempotent and a queued WP is replaced by the newer frame
+         int index = this->find_(request.cmd);
+         if (index >= 0) {
+            if (request.cmd == GATEPRO_CMD_WRITE_PARAMS) {
+               this->entries_[index].params = request.params;
+            }
+            ESP_LOGV(TAG, "Coalesced command %u with the queued one", request.cmd);
+            return true;
+         }
+         break;
+      }
+   }
+
+   if (this->size_ == this->capacity_) {
+      // the last entry has the lowest priority and is the newest of it
+      GateProRequest &victim = this->entries_[this->size_ - 1];
+      this->drops_++;
+      if (priority(victim.cmd) <= prio) {
+         ESP_LOGW(TAG, "TX queue full, dropping command %u", request.cmd);
+         return false;
+      }
+      ESP_LOGW(TAG, "TX queue full, dropping command %u", victim.cmd);
+      this->size_--;
+   }
+
+   // insert behind the last entry of the same or higher priority
+   size_t pos = this->size_;
+   while (pos > 0 && priority(this->entries_[pos - 1].cmd) > prio) {
+      this->entries_[pos] = this->entries_[pos - 1];
+      pos--;
+   }
+   this->entries_[pos] = request;
+   this->size_++;
+   return true;
+}
+
+void GateProCommandQueue::erase(size_t index) {
+   for (size_t i = index; i + 1 < this->size_; i++) {
+      this->entries_[i] = this->entries_[i + 1];
+   }
+   this->size_--;
+}
+
+int GateProCommandQueue::find_(GateProCmd cmd) const {
+   for (size_t i = 0; i < this->size_; i++) {
+      if (this->entries_[i].cmd == cmd) {
+         return i;
+      }
+   }
+   return -1;
+}
+
+// All cover state changes go through here, the publish policy decides
+// whether Home Assistant actually needs to hear about them now.
 void GatePro::publish() {
-    // publish on each tick
-    /*if (this->position_ == this->position) {
+    uint32_t now = millis();
+    bool idle = this->current_operation == cover::COVER_OPERATION_IDLE;
+    float moved = fabsf(this->position - this->published_position_);
+    uint32_t since = now - this->last_publish_;
+
+    if (!this->published_ || this->current_operation != this->published_operation_) {
+      // state and operation changes are never delayed
+    } else if (idle && moved > 0.001f) {
+      // the final position once the gate has settled
+    } else if (!idle && moved >= this->publish_delta_ && since >= this->moving_publish_interval_) {
+      // rate-limited progress while moving
+    } else if (idle && this->heartbeat_interval_ && since >= this->heartbeat_interval_) {
+      ESP_LOGV(TAG, "Heartbeat publish");
+    } else {
       return;
-    }*/
+    }
 
     this->position_ = this->position;
+    this->published_ = true;
+    this->published_position_ = this->position;
+    this->published_operation_ = this->current_operation;
+    this->last_publish_ = now;
     this->publish_state();
 }
 
+////////////////////////////////////////////
+// Parameter decoding
+////////////////////////////////////////////
+bool GateProParams::decode(std::string_view frame, GateProParams *params) {
+   // ACK RP,1:1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0
+   //          ^-after the ':', one hex field per ',' separated token
+   size_t pos = frame.find(':');
+   if (pos == std::string_view::npos) {
+      return false;
+   }
+   pos++;
+
+   GateProParams parsed;
+   uint8_t idx = 0;
+   uint8_t digits = 0;
+   uint8_t value = 0;
+   for (; pos <= frame.size(); pos++) {
+      char c = pos < frame.size() ? frame[pos] : ',';
+      if (c == ',') {
+         if (idx >= COUNT) {
+            return false;
+         }
+         if (digits > 0) {
+            parsed.set(idx, value);
+         }
+         idx++;
+         digits = 0;
+         value = 0;
+         continue;
+      }
+      int8_t v = hex_value(c);
+      if (v < 0 || ++digits > 2) {
+         return false;
+      }
+      value = (value << 4) | v;
+   }
+   if (parsed.valid == 0) {
+      return false;
+   }
+   *params = parsed;
+   return true;
+}
+
+size_t GateProParams::encode(char *buf, size_t len) const {
+   static const char PREFIX[] = "WP,1:";
+   if (!this->complete() || len < MAX_FRAME + 1) {
+      return 0;
+   }
+   size_t n = sizeof(PREFIX) - 1;
+   memcpy(buf, PREFIX, n);
+   for (uint8_t i = 0; i < COUNT; i++) {
+      uint8_t v = this->values[i];
+      if (v > 0x0F) {
+         buf[n++] = HEX_DIGITS[v >> 4];
+      }
+      buf[n++] = HEX_DIGITS[v & 0x0F];
+      if (i != COUNT - 1) {
+         buf[n++] = ',';
+      }
+   }
+   buf[n] = '\0';
+   return n;
+}
+
 ////////////////////////////////////////////
 // GatePro logic functions
 ////////////////////////////////////////////
-void GatePro::process() {
-  if (!this->rx_queue.size()) {
+// Frame dispatch, matched on the frame's leading bytes
+const GatePro::FrameHandler GatePro::FRAME_HANDLERS[] = {
+  // example: ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n
+  {"ACK RS", GATEPRO_ACK_RS, &GatePro::handle_status_},
+  // example: $V1PKF0,17,Closed;src=0001\r\n
+  {"$V1PKF0", GATEPRO_ACK_NONE, &GatePro::handle_motor_event_},
+  // example: ACK RP,1:1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0\r\n
+  {"ACK RP", GATEPRO_ACK_RP, &GatePro::handle_params_},
+  // example: ACK WP,1\r\n
+  {"ACK WP", GATEPRO_ACK_WP, &GatePro::handle_write_ack_},
+  // example: ACK READ DEVINFO:P500BU,PS21053C,V01\r\n
+  {"ACK READ DEVINFO", GATEPRO_ACK_DEVINFO, &GatePro::handle_devinfo_},
+  // example: ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0\r\n
+  {"ACK LEARN STATUS", GATEPRO_ACK_LEARN_STATUS, &GatePro::handle_learn_status_},
+};
+
+// Motor event words, the third field of a $V1PKF0 frame
+struct GateProMotorEvent {
+  std::string_view word;
+  GateProState state;
+};
+static constexpr GateProMotorEvent MOTOR_EVENTS[] = {
+  {"Opening", STATE_OPENING},
+  {"Opened", STATE_OPEN},
+  {"Closing", STATE_CLOSING},
+  {"AutoClosing", STATE_CLOSING},
+  {"Closed", STATE_CLOSED},
+  {"Stopped", STATE_STOPPED},
+};
+
+static bool starts_with(std::string_view str, std::string_view prefix) {
+  return str.size() >= prefix.size() && memcmp(str.data(), prefix.data(), prefix.size()) == 0;
+}
+
+void GatePro::process(std::string_view msg) {
+  this->trace_(TRACE_RX, msg.size(), msg);
+  this->metrics_.count(COUNTER_FRAMES_IN);
+  ESP_LOGV(TAG, "UART RX: %s", this->convert(reinterpret_cast<const uint8_t*>(msg.data()), msg.size()).c_str());
+
+  const FrameHandler *entry = frame_handler_(msg);
+  if (entry == nullptr) {
+    ESP_LOGV(TAG, "Ignoring unknown frame");
     return;
   }
-  std::string msg = this->rx_queue.front();
-  this->rx_queue.pop();
+  // Pair acknowledgements with the request waiting for them
+  if (entry->ack != GATEPRO_ACK_NONE) {
+    this->complete_request_(entry->ack);
+  }
+  (this->*entry->handler)(msg);
+}
 
-  ESP_LOGD(TAG, "UART RX: %s", msg.c_str());
+const GatePro::FrameHandler *GatePro::frame_handler_(std::string_view msg) {
+  for (const auto &entry : FRAME_HANDLERS) {
+    if (starts_with(msg, entry.prefix)) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
 
-  // Process ACK RS status message (position info)
-  // example: ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n
-  if (msg.substr(0, 6) == "ACK RS") {
-    if (msg.length() < 18) {
-      ESP_LOGE(TAG, "ACK RS message too short: %s", msg.c_str());
-      return;
+// Process ACK RS status message (position info)
+void GatePro::handle_status_(std::string_view msg) {
+  GateProStatus status;
+  if (!GateProStatus::decode(msg, &status)) {
+    ESP_LOGE(TAG, "Malformed ACK RS message: %.*s", (int) msg.size(), msg.data());
+    this->metrics_.count(COUNTER_PARSE_FAILURES);
+    return;
+  }
+  this->publish_status_(status);
+  this->status_seen_ = true;
+
+  if (status.count >= 5) {
+    // Check for the specific patterns that indicate a closed or open gate
+    uint32_t pattern = status.pattern();
+    GateEndState seen = END_NONE;
+    if (pattern == GateProStatus::PATTERN_CLOSED) {
+      seen = END_CLOSED;
+      this->patterns_.skip();
+    } else if (pattern == GateProStatus::PATTERN_OPEN) {
+      seen = END_OPEN;
+      this->patterns_.skip();
+    } else {
+      // other controllers' end patterns are learned from the motor events
+      uint32_t signature = status.signature();
+      GateEndState known = this->patterns_.lookup(signature);
+      if (this->patterns_.observe(signature, millis())) {
+        this->patterns_dirty_ = true;  // saved by update(), see save_patterns_()
+      }
+      seen = this->patterns_.lookup(signature);
+      if (seen != known) {
+        ESP_LOGD(TAG, "Status signature %08X now means %s", (unsigned) signature,
+                 seen == END_CLOSED ? "closed" : seen == END_OPEN ? "open" : "nothing");
+      }
     }
-    
-    // Extract the pattern from the message
-    std::string current_pattern = "";
-    if (msg.length() >= 21) {
-      current_pattern = msg.substr(10, 11);
+
+    // Motor events decide the state, patterns confirm them or stand in for a lost one
+    bool was_confirmed = this->estimator_.confirmed();
+    GateEndState adopt = this->estimator_.pattern(seen, millis());
+    if (this->estimator_.confirmed() && !was_confirmed) {
+      ESP_LOGD(TAG, "Status pattern confirms the %s gate", seen == END_CLOSED ? "closed" : "open");
     }
-    
-    // Main logic: Only update states when the gate is in motion or when the state is unknown
-    // This prevents state jumping when the gate is stationary
-    bool should_update_state = !this->operation_finished || this->gate_state_ == STATE_UNKNOWN;
-    
-    // Check for the specific pattern that indicates a closed gate
-    // A2,00,40,00 is the pattern seen in logs when gate is closed
-    if (current_pattern == "A2,00,40,00") {
-      // Track consecutive pattern readings for stability
-      if (this->last_pattern_seen_ == current_pattern) {
-        this->consecutive_pattern_readings_++;
-        ESP_LOGD(TAG, "Consecutive closed pattern readings: %d", this->consecutive_pattern_readings_);
-      } else {
-        // Reset counter if pattern changed
-        this->last_pattern_seen_ = current_pattern;
-        this->consecutive_pattern_readings_ = 1;
-        ESP_LOGD(TAG, "New pattern detected (closed): %s", current_pattern.c_str());
-      }
-      
-      // Only update state if the gate is in motion or the state is unknown
-      // AND we've seen the pattern consistently
-      if (should_update_state && this->consecutive_pattern_readings_ >= 3) {
-        uint32_t now = millis();
-        
-        if (this->gate_state_ != STATE_CLOSED) {
-          ESP_LOGI(TAG, "Detected closed gate pattern (%d readings), updating state to closed", 
-                   this->consecutive_pattern_readings_);
-          GateProState old_state = this->gate_state_;
-          this->gate_state_ = STATE_CLOSED;
-          this->position = cover::COVER_CLOSED; // 1.0f
-          this->position_ = cover::COVER_CLOSED;
-          this->current_operation = cover::COVER_OPERATION_IDLE;
-          this->operation_finished = true; // Mark operation as finished if we detect a stable state
-          this->last_state_change_ = now;
-          this->log_state_change(old_state, this->gate_state_);
-          this->publish_state();
-        }
+
+    if (seen != END_NONE) {
+      GateProState pattern_state = seen == END_CLOSED ? STATE_CLOSED : STATE_OPEN;
+      if (adopt != END_NONE && this->gate_state_ != pattern_state) {
+        ESP_LOGI(TAG, "Detected %s gate pattern (%d readings), updating state",
+                 pattern_state == STATE_CLOSED ? "closed" : "open", this->estimator_.readings());
+        GateProState old_state = this->gate_state_;
+        this->gate_state_ = pattern_state;
+        this->position = pattern_state == STATE_CLOSED ? cover::COVER_CLOSED : cover::COVER_OPEN;
+        this->position_ = this->position;
+        this->motion_.stop(this->position, millis());
+        this->current_operation = cover::COVER_OPERATION_IDLE;
+        this->operation_finished = true; // Mark operation as finished if we detect a stable state
+        this->last_state_change_ = millis();
+        this->log_state_change(old_state, this->gate_state_);
+        this->publish();
       }
       return;
     }
+  }
+
+  // The first position after a planned STOP is where the leaf came to rest
+  if (this->stop_planner_.landing()) {
+    this->landed_((float) status.position_percent() / 100);
+    return;
+  }
+
+  // For position updates, only process them if the gate is in motion
+  // This prevents position updates when the gate is stationary
+  if (!this->operation_finished || this->current_operation != cover::COVER_OPERATION_IDLE) {
+    float new_position = (float) status.position_percent() / 100;
     
-    // Check for the specific pattern that indicates an open gate
-    // A2,E3,40,00 is the pattern seen in logs when gate is open
-    if (current_pattern == "A2,E3,40,00") {
-      // Track consecutive pattern readings for stability
-      if (this->last_pattern_seen_ == current_pattern) {
-        this->consecutive_pattern_readings_++;
-        ESP_LOGD(TAG, "Consecutive open pattern readings: %d", this->consecutive_pattern_readings_);
-      } else {
-        // Reset counter if pattern changed
-        this->last_pattern_seen_ = current_pattern;
-        this->consecutive_pattern_readings_ = 1;
-        ESP_LOGD(TAG, "New pattern detected (open): %s", current_pattern.c_str());
-      }
-      
-      // Only update state if the gate is in motion or the state is unknown
-      // AND we've seen the pattern consistently
-      if (should_update_state && this->consecutive_pattern_readings_ >= 3) {
-        uint32_t now = millis();
-        
-        if (this->gate_state_ != STATE_OPEN) {
-          ESP_LOGI(TAG, "Detected open gate pattern (%d readings), updating state to open", 
-                   this->consecutive_pattern_readings_);
-          GateProState old_state = this->gate_state_;
-          this->gate_state_ = STATE_OPEN;
-          this->position = cover::COVER_OPEN; // 0.0f
-          this->position_ = cover::COVER_OPEN;
-          this->current_operation = cover::COVER_OPERATION_IDLE;
-          this->operation_finished = true; // Mark operation as finished if we detect a stable state
-          this->last_state_change_ = now;
-          this->log_state_change(old_state, this->gate_state_);
-          this->publish_state();
-        }
+    if (this->operation_finished && this->current_operation == cover::COVER_OPERATION_IDLE) {
+      if (new_position <= 0.01f) {
+          new_position = 0.0f;
+      } else if (new_position >= 0.99f) {
+          new_position = 1.0f;
       }
-      return;
     }
     
-    // If we get here, we've seen a different pattern
-    if (!current_pattern.empty() && this->last_pattern_seen_ != current_pattern) {
-      this->last_pattern_seen_ = current_pattern;
-      this->consecutive_pattern_readings_ = 1;
-      ESP_LOGD(TAG, "New pattern detected (other): %s", current_pattern.c_str());
-    } else if (!current_pattern.empty()) {
-      this->consecutive_pattern_readings_++;
-      ESP_LOGD(TAG, "Consecutive other pattern readings: %d for %s", 
-               this->consecutive_pattern_readings_, current_pattern.c_str());
-    }
+    // Update position only while in motion, the sample also corrects the
+    // interpolation and refines the learned speed
+    this->motion_.sample(new_position, millis());
+    this->position = new_position;
+    this->position_ = new_position;
+    this->publish();
     
-    // For position updates, only process them if the gate is in motion
-    // This prevents position updates when the gate is stationary
-    if (!this->operation_finished || this->current_operation != cover::COVER_OPERATION_IDLE) {
-      // Extract the position value (hex)
-      std::string position_hex = msg.substr(16, 2);
-      
-      // Convert hex to integer safely
-      char* end;
-      int percentage = strtol(position_hex.c_str(), &end, 16);
-      
-      // Check if conversion was successful
-      if (*end != '\0') {
-        ESP_LOGE(TAG, "Failed to parse position from ACK RS message: %s", msg.c_str());
-        return;
-      }
-      
-      // percentage correction with known offset, if necessary
-      if (percentage > 100) {
-        percentage -= this->known_percentage_offset;
-      }
-      
-      float new_position = (float)percentage / 100;
-      
-      if (this->operation_finished && this->current_operation == cover::COVER_OPERATION_IDLE) {
-        if (new_position <= 0.01f) {
-            new_position = 0.0f;
-        } else if (new_position >= 0.99f) {
-            new_position = 1.0f;
-        }
-      }
-      
-      // Update position only while in motion
-      this->position = new_position;
-      this->position_ = new_position;
-      this->publish_state();
-      
-      ESP_LOGD(TAG, "Updated position during motion: %.2f", new_position);
-    }
+    ESP_LOGV(TAG, "Updated position during motion: %.2f", new_position);
+
+    // Check if we need to stop at target position
+    this->stop_at_target_position();
+  }
+}
+
+void GatePro::publish_status_(const GateProStatus &status) {
+  bool changed = status.count != this->status_.count ||
+                 memcmp(status.bytes, this->status_.bytes, status.count) != 0;
+  this->status_ = status;
+  if (!changed || !this->txt_status) {
     return;
   }
+  char buf[GateProStatus::SIZE * 3];
+  size_t len = 0;
+  for (uint8_t i = 0; i < status.count; i++) {
+    len += snprintf(buf + len, sizeof(buf) - len, i ? ",%02X" : "%02X", status.bytes[i]);
+  }
+  this->txt_status->publish_state(std::string(buf, len));
+}
 
-  // Event message from the motor
-  // example: $V1PKF0,17,Closed;src=0001\r\n
-  if (msg.substr(0, 7) == "$V1PKF0") {
-    ESP_LOGI(TAG, "Received motor event: %s", msg.c_str());
-    GateProState old_state = this->gate_state_;
-    uint32_t now = millis();
-    
-    // Reset pattern detection when we receive direct motor events
-    this->last_pattern_seen_ = "";
-    this->consecutive_pattern_readings_ = 0;
-    
-    if (msg.substr(11, 7) == "Opening") {
+// Event message from the motor
+void GatePro::handle_motor_event_(std::string_view msg) {
+  ESP_LOGI(TAG, "Received motor event: %.*s", (int) msg.size(), msg.data());
+
+  // "$V1PKF0,<code>,<event>;src=...", the event word is the third field
+  size_t start = msg.find(',', 8);
+  std::string_view word = start == std::string_view::npos ? std::string_view() : msg.substr(start + 1);
+  word = word.substr(0, word.find_first_of(",;"));
+
+  for (const auto &event : MOTOR_EVENTS) {
+    if (word == event.word) {
+      this->apply_motor_event_(event.state);
+      return;
+    }
+  }
+  ESP_LOGW(TAG, "Unknown motor event: %.*s", (int) word.size(), word.data());
+  this->metrics_.count(COUNTER_PARSE_FAILURES);
+}
+
+void GatePro::apply_motor_event_(GateProState state) {
+  GateProState old_state = this->gate_state_;
+  uint32_t now = millis();
+
+  this->trace_(TRACE_MOTOR, state);
+
+  // Time from the OPEN/CLOSE write to the motor reporting the movement
+  if (this->motion_pending_) {
+    this->motion_pending_ = false;
+    uint32_t latency = now - this->motion_sent_at_;
+    if ((state == STATE_OPENING || state == STATE_CLOSING) && latency <= MAX_MOTION_LATENCY) {
+      this->metrics_.add_latency(LATENCY_MOTION, latency);
+    }
+  }
+
+  // Events are taken as they come, RS patterns only confirm them from now on
+  GateEndState end = state == STATE_OPEN ? END_OPEN : state == STATE_CLOSED ? END_CLOSED : END_NONE;
+  this->estimator_.event(end, now);
+  // the status that follows a resting gate teaches the pattern table
+  this->patterns_.event(end, state == STATE_OPEN || state == STATE_CLOSED || state == STATE_STOPPED, now);
+
+  switch (state) {
+    case STATE_OPENING:
       ESP_LOGI(TAG, "Gate is opening");
       this->operation_finished = false;
       this->current_operation = cover::COVER_OPERATION_OPENING;
       this->last_operation_ = cover::COVER_OPERATION_OPENING;
-      this->gate_state_ = STATE_OPENING;
-      this->last_state_change_ = now;
-      this->log_state_change(old_state, this->gate_state_);
-      this->publish_state();
-      return;
-    }
-    else if (msg.substr(11, 6) == "Opened") {
+      this->motion_.start(1, this->position, now);
+      if (!this->stop_planner_.armed()) {
+        this->stop_planner_.disarm();  // moved by a remote or a full open
+      }
+      this->poll_now_();
+      break;
+    case STATE_OPEN:
       ESP_LOGI(TAG, "Gate is fully open");
       this->operation_finished = true;
       this->position = cover::COVER_OPEN; // 0.0f
       this->position_ = cover::COVER_OPEN;
       this->current_operation = cover::COVER_OPERATION_IDLE;
-      this->gate_state_ = STATE_OPEN;
-      this->last_state_change_ = now;
-      this->log_state_change(old_state, this->gate_state_);
-      this->publish_state();
-      return;
-    }
-    else if (msg.substr(11, 7) == "Closing" || msg.substr(11, 11) == "AutoClosing") {
+      this->motion_.stop(this->position, now);
+      this->stop_planner_.disarm();
+      break;
+    case STATE_CLOSING:
       ESP_LOGI(TAG, "Gate is closing");
       this->operation_finished = false;
       this->current_operation = cover::COVER_OPERATION_CLOSING;
       this->last_operation_ = cover::COVER_OPERATION_CLOSING;
-      this->gate_state_ = STATE_CLOSING;
-      this->last_state_change_ = now;
-      this->log_state_change(old_state, this->gate_state_);
-      this->publish_state();
-      return;
-    }
-    else if (msg.substr(11, 6) == "Closed") {
+      this->motion_.start(-1, this->position, now);
+      if (!this->stop_planner_.armed()) {
+        this->stop_planner_.disarm();
+      }
+      this->poll_now_();
+      break;
+    case STATE_CLOSED:
       ESP_LOGI(TAG, "Gate is fully closed");
       this->operation_finished = true;
       this->position = cover::COVER_CLOSED; // 1.0f
       this->position_ = cover::COVER_CLOSED;
       this->current_operation = cover::COVER_OPERATION_IDLE;
-      this->gate_state_ = STATE_CLOSED;
-      this->last_state_change_ = now;
-      this->log_state_change(old_state, this->gate_state_);
-      this->publish_state();
-      return;
-    }
-    else if (msg.substr(11, 7) == "Stopped") {
+      this->motion_.stop(this->position, now);
+      this->stop_planner_.disarm();
+      break;
+    case STATE_STOPPED:
       ESP_LOGI(TAG, "Gate has stopped");
       this->operation_finished = true;
       this->current_operation = cover::COVER_OPERATION_IDLE;
-      this->gate_state_ = STATE_STOPPED;
-      this->last_state_change_ = now;
-      this->log_state_change(old_state, this->gate_state_);
+      this->motion_.stop(this->position, now);
+      this->stop_planner_.motor_stopped();
       // Request status to get current position
       this->queue_gatepro_cmd(GATEPRO_CMD_READ_STATUS);
-      this->publish_state();
+      break;
+    default:
       return;
-    }
   }
-  
-  // Read param example: ACK RP,1:1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0\r\n
-  if (msg.substr(0, 6) == "ACK RP") {
-      this->parse_params(msg);
-      return;
-   }
 
-   // ACK WP example: ACK WP,1\r\n
-   if (msg.substr(0, 6) == "ACK WP") {
-      ESP_LOGD(TAG, "Write params acknowledged");
-      return;
-   }
+  this->gate_state_ = state;
+  this->last_state_change_ = now;
+  this->log_state_change(old_state, this->gate_state_);
+  this->publish();
+}
 
-   // Devinfo example: ACK READ DEVINFO:P500BU,PS21053C,V01\r\n
-   if (msg.substr(0, 16) == "ACK READ DEVINFO") {
-      if (this->txt_devinfo) {
-        this->txt_devinfo->publish_state(msg.substr(17, msg.size() - (17 + 4)));
-      }
-      return;
-   }
+void GatePro::handle_params_(std::string_view msg) {
+  this->parse_params(msg);
+}
 
-   // Learn status example: ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0\r\n
-   if (msg.substr(0, 16) == "ACK LEARN STATUS") {
-      if (this->txt_learn_status) {
-        this->txt_learn_status->publish_state(msg.substr(17, msg.size() - (17 + 4)));
-      }
-      return;
-   }
+void GatePro::handle_write_ack_(std::string_view msg) {
+  ESP_LOGD(TAG, "Write params acknowledged: %.*s", (int) msg.size(), msg.data());
+  // read params again to verify the write, an RP sent before the gate took
+  // the WP would only report the old values
+  if (this->param_txn_ != PARAM_TXN_VERIFYING || this->param_txn_rp_sent_) {
+    return;
+  }
+  this->param_txn_enter_(PARAM_TXN_VERIFYING);
+  if (!this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS)) {
+    this->param_txn_abort_("verify RP not queued");
+  }
+}
+
+void GatePro::handle_devinfo_(std::string_view msg) {
+  if (msg.size() <= 17) {
+    return;
+  }
+  std::string_view info = msg.substr(17);
+  if (this->txt_devinfo) {
+    this->txt_devinfo->publish_state(std::string(info));
+  }
+  GateProCache cache = this->cache_;
+  memset(cache.devinfo, 0, sizeof(cache.devinfo));
+  memcpy(cache.devinfo, info.data(), std::min(info.size(), sizeof(cache.devinfo) - 1));
+  this->save_cache_(cache);
+}
+
+void GatePro::handle_learn_status_(std::string_view msg) {
+  if (this->txt_learn_status && msg.size() > 17) {
+    this->txt_learn_status->publish_state(std::string(msg.substr(17)));
+  }
 }
+
+////////////////////////////////////////////
 // Cover component logic functions
 ////////////////////////////////////////////
 void GatePro::control(const cover::CoverCall &call) {
@@ -318,7 +680,11 @@ void GatePro::control(const cover::CoverCall &call) {
     this->queue_gatepro_cmd(GATEPRO_CMD_STOP);
     this->current_operation = cover::COVER_OPERATION_IDLE;
     this->operation_finished = true;
-    this->publish_state();
+    this->motion_.stop(this->position, millis());
+    if (this->stop_planner_.armed()) {
+      this->stop_planner_.disarm();  // stopped by hand before the target
+    }
+    this->publish();
     return;
   }
 
@@ -334,7 +700,8 @@ void GatePro::control(const cover::CoverCall &call) {
       this->last_operation_ = cover::COVER_OPERATION_OPENING;
       this->operation_finished = false;
       this->target_position_ = cover::COVER_OPEN;
-      this->publish_state();
+      this->stop_planner_.disarm();
+      this->publish();
       return;
     }
     
@@ -346,7 +713,8 @@ void GatePro::control(const cover::CoverCall &call) {
       this->last_operation_ = cover::COVER_OPERATION_CLOSING;
       this->operation_finished = false;
       this->target_position_ = cover::COVER_CLOSED;
-      this->publish_state();
+      this->stop_planner_.disarm();
+      this->publish();
       return;
     }
     
@@ -363,13 +731,14 @@ void GatePro::control(const cover::CoverCall &call) {
     
     // Send the appropriate command
     this->queue_gatepro_cmd(closing ? GATEPRO_CMD_CLOSE : GATEPRO_CMD_OPEN);
+    this->stop_planner_.arm(pos, closing ? -1 : 1);
     
     // Update state variables
     this->current_operation = closing ? cover::COVER_OPERATION_CLOSING : cover::COVER_OPERATION_OPENING;
     this->last_operation_ = this->current_operation;
     this->operation_finished = false;
     
-    this->publish_state();
+    this->publish();
   }
 }
 
@@ -429,7 +798,7 @@ void GatePro::start_direction_(cover::CoverOperation dir) {
   }
   
   // Publish the state immediately to update the UI
-  this->publish_state();
+  this->publish();
 }
 
 void GatePro::correction_after_operation() {
@@ -454,15 +823,59 @@ void GatePro::correction_after_operation() {
   // These message handlers were moved to process() method
 }
 
+void GatePro::interpolate_position_(uint32_t now) {
+  if (!this->motion_.moving() || this->operation_finished) {
+    return;
+  }
+  float estimate = this->motion_.estimate(now);
+  if (fabsf(estimate - this->position) < INTERPOLATION_STEP) {
+    return;
+  }
+  ESP_LOGV(TAG, "Interpolated position: %.2f", estimate);
+  this->position = estimate;
+  this->position_ = estimate;
+  this->publish();
+  this->stop_at_target_position();
+}
+
 void GatePro::stop_at_target_position() {
-  if (this->target_position_ &&
-      this->target_position_ != cover::COVER_OPEN &&
-      this->target_position_ != cover::COVER_CLOSED) {
-    const float diff = abs(this->position - this->target_position_);
-    if (diff < this->acceptable_diff) {
-      this->make_call().set_command_stop().perform();
-    }
+  if (!this->stop_planner_.armed() || this->operation_finished) {
+    return;
   }
+  float velocity = this->motion_.velocity(this->motion_.direction());
+  uint32_t latency = this->stop_latency_(millis());
+  if (!this->stop_planner_.should_stop(this->position, velocity, latency)) {
+    return;
+  }
+  ESP_LOGI(TAG, "Stopping at %.2f for target %.2f (%.3f/s, %ums latency, %ums coast)", this->position,
+           this->stop_planner_.target(), velocity, latency, this->stop_planner_.coast(this->motion_.direction()));
+  this->stop_planner_.fired(velocity);
+  this->make_call().set_command_stop().perform();
+}
+
+uint32_t GatePro::stop_latency_(uint32_t now) const {
+  // wait for the bus, then shift out "STOP;src=<source>\r\n" at 10 bits per byte
+  int32_t wait = (int32_t) (this->tx_busy_until_ + this->inter_frame_gap_ - now);
+  size_t len = this->command_frame_(GATEPRO_CMD_STOP).size();
+  uint32_t baud_rate = std::max<uint32_t>(this->parent_->get_baud_rate(), 1);
+  return std::max<int32_t>(wait, 0) + (len * 10 * 1000 + baud_rate - 1) / baud_rate;
+}
+
+void GatePro::landed_(float position) {
+  int8_t direction = this->last_operation_ == cover::COVER_OPERATION_OPENING ? 1 : -1;
+  float target = this->stop_planner_.target();
+  if (this->stop_planner_.landed(position)) {
+    ESP_LOGI(TAG, "Landed at %.2f for target %.2f, coast time now %ums", position, target,
+             this->stop_planner_.coast(direction));
+    GateProCache cache = this->cache_;
+    cache.coast[0] = this->stop_planner_.coast(1);
+    cache.coast[1] = this->stop_planner_.coast(-1);
+    this->save_cache_(cache);
+  }
+  this->motion_.stop(position, millis());
+  this->position = position;
+  this->position_ = position;
+  this->publish();
 }
 
 void GatePro::update_state_from_position(float position) {
@@ -530,71 +943,179 @@ void GatePro::log_state_change(GateProState old_state, GateProState new_state) {
 void GatePro::read_uart() {
     // Check if anything on UART buffer
     int available = this->available();
-    if (!available) {
-        return;
-    }
-    
-    // Buffer overflow protection - clear if too large
-    if (this->msg_buff.length() > MAX_UART_BUFFER_SIZE) {
-        ESP_LOGW(TAG, "UART buffer overflow (%zu bytes), clearing buffer", this->msg_buff.length());
-        this->msg_buff.clear();
-    }
-    
-    // Use stack-based buffer to avoid dynamic allocation
-    uint8_t bytes[UART_READ_BUFFER_SIZE];
-    int to_read = std::min(available, (int)UART_READ_BUFFER_SIZE);
-    
-    // Read available data in chunks if necessary
-    while (available > 0 && this->msg_buff.length() < MAX_UART_BUFFER_SIZE) {
-        int chunk_size = std::min(available, (int)UART_READ_BUFFER_SIZE);
-        this->read_array(bytes, chunk_size);
-        this->msg_buff += this->convert(bytes, chunk_size);
+
+    // Read straight into the free region of the RX ring
+    while (available > 0) {
+        uint8_t *window;
+        size_t room = this->rx_framer_.write_window(&window);
+        if (!room) {
+            std::string_view frame;
+            if (this->rx_framer_.peek_frame(&frame)) {
+                // complete frames are pending, leave the rest in the UART FIFO
+                break;
+            }
+            // Buffer overflow protection - no delimiter in a full ring, drop
+            // it along with the rest of that frame
+            ESP_LOGW(TAG, "UART buffer overflow (%zu bytes), clearing buffer", this->rx_framer_.size());
+            this->trace_(TRACE_RESYNC, this->rx_framer_.size());
+            this->metrics_.count(COUNTER_RX_OVERFLOWS);
+            this->rx_framer_.resync();
+            continue;
+        }
+
+        size_t chunk_size = std::min((size_t) available, room);
+        if (!this->read_array(window, chunk_size)) {
+            break;
+        }
+        this->capture_.record(micros(), CAPTURE_RX, window, chunk_size);
+        this->rx_framer_.commit(chunk_size);
+        this->last_rx_ = millis();
         available -= chunk_size;
-        
-        // Update available count
-        available = this->available();
     }
+}
 
-    // Process all complete messages in the buffer
-    size_t pos;
-    int processed_messages = 0;
-    const int MAX_MESSAGES_PER_CYCLE = 5; // Prevent infinite loops
-    
-    while ((pos = this->msg_buff.find(this->delimiter)) != std::string::npos && 
-           processed_messages < MAX_MESSAGES_PER_CYCLE) {
-        
-        // Extract complete message
-        std::string complete_msg = this->msg_buff.substr(0, pos + this->delimiter_length);
-        
-        // Add to processing queue
-        this->rx_queue.push(complete_msg);
-        
-        // Remove processed message from buffer
-        this->msg_buff = this->msg_buff.substr(pos + this->delimiter_length);
-        
-        processed_messages++;
-        
-        ESP_LOGD(TAG, "Processed message %d: %s", processed_messages, complete_msg.c_str());
-    }
-    
-    // Log if we hit the message limit
-    if (processed_messages >= MAX_MESSAGES_PER_CYCLE) {
-        ESP_LOGD(TAG, "Processed maximum messages per cycle (%d), remaining buffer: %zu bytes", 
-                 MAX_MESSAGES_PER_CYCLE, this->msg_buff.length());
-    }
+bool GatePro::bus_free_(uint32_t now) {
+   if (this->bus_ && this->bus_->shared(this)) {
+      return this->bus_->wire_free(this, now);
+   }
+   // wait for our last frame to be shifted out, then keep the gap
+   if ((int32_t) (now - this->tx_busy_until_) < (int32_t) this->inter_frame_gap_) {
+      return false;
+   }
+   // don't talk over the controller while it is sending a frame
+   if (this->rx_framer_.size() && now - this->last_rx_ < this->inter_frame_gap_) {
+      return false;
+   }
+   return true;
 }
 
 void GatePro::write_uart() {
-   if (this->tx_queue.size()) {
-      std::string cmd_str = this->tx_queue.front();
-      cmd_str += this->tx_delimiter;
-      this->write_str(cmd_str.c_str());
-      ESP_LOGD(TAG, "UART TX[%d]: %s", this->tx_queue.size(), cmd_str.c_str());
-      this->tx_queue.pop();
+   uint32_t now = millis();
+   this->check_timeouts_(now);
+   if (!this->bus_free_(now)) {
+      return;
+   }
+
+   // Retries of timed out requests go first, unless STOP or motion is waiting
+   bool motion_pending = !this->tx_queue.empty() &&
+       GateProCommandQueue::priority(this->tx_queue[0].cmd) <= GATEPRO_PRIORITY_MOTION;
+   for (auto &slot : this->in_flight_) {
+      if (motion_pending) {
+         break;
+      }
+      if (slot.active && slot.retry_due) {
+         slot.retry_due = false;
+         slot.attempts++;
+         slot.sent_at = now;
+         const char *frame = this->request_text_(slot.request);
+         this->trace_(TRACE_RETRY, slot.attempts + 1, frame);
+         ESP_LOGV(TAG, "Retrying %s (attempt %u)", frame, slot.attempts + 1);
+         this->send_request_(slot.request, now);
+         return;
+      }
+   }
+
+   // Next queued command whose acknowledgement type is not outstanding
+   for (size_t i = 0; i < this->tx_queue.size(); i++) {
+      const GateProRequest &request = this->tx_queue[i];
+      GateProAck ack = expected_ack(request.cmd);
+      if (ack != GATEPRO_ACK_NONE && this->in_flight_[ack].active) {
+         continue;
+      }
+      // on a shared UART, wait for the turn and for other gates' answers
+      if (this->bus_ && this->bus_->shared(this) && !this->bus_->may_send(this, request.cmd)) {
+         continue;
+      }
+      if (ack != GATEPRO_ACK_NONE) {
+         GateProInFlight &slot = this->in_flight_[ack];
+         slot.active = true;
+         slot.retry_due = false;
+         slot.request = request;
+         slot.first_sent_at = now;
+         slot.sent_at = now;
+         slot.timeout = ACK_TIMEOUTS[ack];
+         slot.attempts = 0;
+      }
+      this->metrics_.add_latency(LATENCY_COMMAND, now - request.queued_at);
+      this->send_request_(request, now);
+      this->tx_queue.erase(i);
+      return;
    }
 }
 
-std::string GatePro::convert(uint8_t* bytes, size_t len) {
+void GatePro::send_request_(const GateProRequest &request, uint32_t now) {
+   // fixed commands are prebuilt, only the WP is encoded on the stack
+   std::string_view out;
+   char wp[GateProParams::MAX_FRAME + sizeof(TX_DELIMITER)];
+   if (request.cmd == GATEPRO_CMD_WRITE_PARAMS) {
+      size_t n = request.params.encode(wp, sizeof(wp));
+      if (n != 0) {
+         memcpy(wp + n, TX_DELIMITER, sizeof(TX_DELIMITER) - 1);
+         out = std::string_view(wp, n + sizeof(TX_DELIMITER) - 1);
+      }
+   } else {
+      out = this->command_frame_(request.cmd);
+   }
+   if (out.empty()) {
+      ESP_LOGE(TAG, "No frame for command %u", request.cmd);
+      return;
+   }
+   size_t len = out.size();
+   std::string_view frame = out.substr(0, len - (sizeof(TX_DELIMITER) - 1));
+   this->write_array(reinterpret_cast<const uint8_t *>(out.data()), len);
+   this->capture_.record(micros(), CAPTURE_TX, reinterpret_cast<const uint8_t *>(out.data()), len);
+   this->trace_(TRACE_TX, this->tx_queue.size(), frame);
+   this->metrics_.count(COUNTER_FRAMES_OUT);
+   if (GateProCommandQueue::priority(request.cmd) == GATEPRO_PRIORITY_MOTION) {
+      this->motion_pending_ = true;
+      this->motion_sent_at_ = now;
+   }
+   if (request.cmd == GATEPRO_CMD_READ_PARAMS && this->param_txn_waiting_()) {
+      this->param_txn_rp_sent_ = true;
+   }
+   ESP_LOGV(TAG, "UART TX[%zu]: %.*s", this->tx_queue.size(), (int) frame.size(), frame.data());
+
+   // 10 bits per byte on the wire (start + 8 data + stop)
+   uint32_t baud_rate = std::max<uint32_t>(this->parent_->get_baud_rate(), 1);
+   this->tx_busy_until_ = now + (len * 10 * 1000 + baud_rate - 1) / baud_rate;
+}
+
+void GatePro::check_timeouts_(uint32_t now) {
+   for (auto &slot : this->in_flight_) {
+      if (!slot.active || slot.retry_due || now - slot.sent_at < slot.timeout) {
+         continue;
+      }
+      if (slot.attempts >= MAX_RETRIES) {
+         const char *frame = this->request_text_(slot.request);
+         this->trace_(TRACE_GIVE_UP, slot.attempts + 1, frame);
+         ESP_LOGW(TAG, "No acknowledgement for %s after %u attempts, giving up", frame, slot.attempts + 1);
+         slot.active = false;
+         if (slot.request.cmd == GATEPRO_CMD_READ_PARAMS && this->param_txn_waiting_() && this->param_txn_rp_sent_) {
+            this->param_txn_abort_("no answer to RP");
+         }
+         continue;
+      }
+      // back off before the next attempt is considered lost
+      slot.timeout = std::min(slot.timeout * 2, MAX_ACK_TIMEOUT);
+      slot.retry_due = true;
+   }
+}
+
+void GatePro::complete_request_(GateProAck ack) {
+   GateProInFlight &slot = this->in_flight_[ack];
+   if (!slot.active) {
+      return;
+   }
+   // retries included, that is what the caller waited
+   uint32_t latency = millis() - slot.first_sent_at;
+   this->metrics_.add_latency(LATENCY_ACK, latency);
+   ESP_LOGV(TAG, "%s acknowledged after %ums", this->request_text_(slot.request), latency);
+   slot.active = false;
+   slot.retry_due = false;
+}
+
+// Escapes raw bytes for log output
+std::string GatePro::convert(const uint8_t* bytes, size_t len) {
   std::string res;
   char buf[5];
   for (size_t i = 0; i < len; i++) {
@@ -634,100 +1155,244 @@ std::string GatePro::convert(uint8_t* bytes, size_t len) {
 ////////////////////////////////////////////
 // Parameter functions
 ////////////////////////////////////////////
+// Parameter changes are not written one by one. They are collected in a
+// dirty mask for param_commit_window_, then a single transaction reads the
+// current parameters, applies every change, writes one WP frame and reads
+// the parameters back to verify them.
 void GatePro::set_param(int idx, int val) {
-   ESP_LOGD(TAG, "Initiating setting param %d to %d", idx, val);
-   
    // Validate parameter index
-   if (idx < 0 || idx >= 17) {  // GatePro has 17 parameters (0-16)
+   if (idx < 0 || idx >= GateProParams::COUNT) {  // GatePro has 17 parameters (0-16)
       ESP_LOGE(TAG, "Invalid parameter index: %d (valid range: 0-16)", idx);
       return;
    }
-   
-   this->param_no_pub = true;
-   this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS);
+   if (val < 0 || val > 0xFF) {
+      ESP_LOGE(TAG, "Invalid value %d for parameter %d", val, idx);
+      return;
+   }
 
-   this->paramTaskQueue.push(
-      [this, idx, val](){
-         ESP_LOGD(TAG, "Setting param %d to %d", idx, val);
-         // Ensure params vector is large enough
-         if (this->params.size() <= idx) {
-            this->params.resize(idx + 1, 0);
-         }
-         this->params[idx] = val;
-         this->write_params();
-      });
+   ESP_LOGD(TAG, "Queueing param %d = %d", idx, val);
+   this->param_changes_.set(idx, val);
+   if (this->param_txn_ == PARAM_TXN_IDLE) {
+      this->param_txn_ = PARAM_TXN_COLLECTING;
+      this->param_commit_at_ = millis() + this->param_commit_window_;
+   }
+   // changes arriving later in a transaction are picked up by the next one
+}
+
+void GatePro::param_txn_loop_(uint32_t now) {
+   // a transaction that lost its RP or WP must not block the next changes
+   if (this->param_txn_waiting_() && (int32_t) (now - this->param_txn_deadline_) >= 0) {
+      this->param_txn_abort_("timed out");
+      return;
+   }
+   if (this->param_txn_ != PARAM_TXN_COLLECTING || (int32_t) (now - this->param_commit_at_) < 0) {
+      return;
+   }
+   ESP_LOGD(TAG, "Committing param changes, mask 0x%05X", (unsigned) this->param_changes_.valid);
+   this->param_txn_enter_(PARAM_TXN_READING);
+   if (!this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS)) {
+      this->param_txn_abort_("RP not queued");
+   }
+}
+
+void GatePro::param_txn_enter_(GateProParamTxn phase) {
+   this->param_txn_ = phase;
+   this->param_txn_deadline_ = millis() + PARAM_TXN_TIMEOUT;
+   this->param_txn_rp_sent_ = false;
+}
+
+void GatePro::param_txn_read_() {
+   // merge the dirty fields into what the gate just reported
+   uint32_t differs = 0;
+   for (uint8_t i = 0; i < GateProParams::COUNT; i++) {
+      if (this->param_changes_.has(i) && !(this->params.has(i) && this->params[i] == this->param_changes_[i])) {
+         differs |= 1u << i;
+      }
+   }
+   if (differs == 0) {
+      ESP_LOGD(TAG, "Params already up to date, nothing to write");
+      this->param_changes_.valid = 0;
+      this->param_txn_ = PARAM_TXN_IDLE;
+      return;
+   }
+   if (!this->params.complete()) {
+      this->param_txn_abort_("parameters incomplete");
+      return;
+   }
+
+   this->param_written_ = GateProParams();
+   for (uint8_t i = 0; i < GateProParams::COUNT; i++) {
+      if (differs & (1u << i)) {
+         this->params.set(i, this->param_changes_[i]);
+         this->param_written_.set(i, this->param_changes_[i]);
+      }
+   }
+   this->param_changes_.valid = 0;
+   this->param_txn_enter_(PARAM_TXN_VERIFYING);
+   if (!this->write_params()) {
+      this->param_txn_abort_("WP not queued");
+   }
+}
+
+void GatePro::param_txn_verify_() {
+   for (uint8_t i = 0; i < GateProParams::COUNT; i++) {
+      if (this->param_written_.has(i) && this->params[i] != this->param_written_[i]) {
+         ESP_LOGW(TAG, "Param %u reads back as %u, expected %u", i, this->params[i], this->param_written_[i]);
+      }
+   }
+   this->param_written_.valid = 0;
+   if (this->param_changes_.valid != 0) {
+      // changes made while this transaction ran, commit them right away
+      this->param_txn_ = PARAM_TXN_COLLECTING;
+      this->param_commit_at_ = millis();
+   } else {
+      this->param_txn_ = PARAM_TXN_IDLE;
+   }
+}
+
+void GatePro::param_txn_abort_(const char *reason) {
+   ESP_LOGW(TAG, "Dropping param changes (mask 0x%05X): %s",
+            (unsigned) (this->param_changes_.valid | this->param_written_.valid), reason);
+   this->param_changes_.valid = 0;
+   this->param_written_.valid = 0;
+   this->param_txn_ = PARAM_TXN_IDLE;
+   // put the entities back to what the gate reported
+   this->publish_params();
 }
 
 void GatePro::publish_params() {
-   if (!this->param_no_pub && this->params.size() >= 16) {  // Ensure we have enough parameters
-      // Safely publish parameters with bounds checking
-      if (this->speed_slider && this->params.size() > 3) 
-         this->speed_slider->publish_state(this->params[3]);
-      if (this->decel_dist_slider && this->params.size() > 4) 
-         this->decel_dist_slider->publish_state(this->params[4]);
-      if (this->decel_speed_slider && this->params.size() > 5) 
-         this->decel_speed_slider->publish_state(this->params[5]);
-      if (this->max_amp_slider && this->params.size() > 6) 
-         this->max_amp_slider->publish_state(this->params[6]);
-      if (this->auto_close_slider && this->params.size() > 1) 
-         this->auto_close_slider->publish_state(this->params[1]);
-      if (this->sw_permalock && this->params.size() > 15) 
-         this->sw_permalock->publish_state(this->params[15]);
-      if (this->sw_infra1 && this->params.size() > 13) 
-         this->sw_infra1->publish_state(this->params[13]);
-      if (this->sw_infra2 && this->params.size() > 14) 
-         this->sw_infra2->publish_state(this->params[14]);
-      if (this->small_gate_timer && this->params.size() > 7) 
-        this->small_gate_timer->publish_state(this->params[7]);
-      if (this->force_detection_number && this->params.size() > 9) 
-        this->force_detection_number->publish_state(this->params[9]);
-   }
-}
-
-void GatePro::parse_params(std::string msg) {
-   this->params.clear();
-   // example: ACK RP,1:1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0\r\n
-   //                   ^-9  
-   msg = msg.substr(9, 33);
-   size_t start = 0;
-   size_t end;
-
-   // efficiently split on ','
-   while((end = msg.find(',', start)) != std::string::npos) {
-      this->params.push_back(stoi(msg.substr(start, end - start)));
-      start = end + 1;
-   }
-   this->params.push_back(stoi(msg.substr(start)));
-
-   ESP_LOGD(TAG, "Parsed current params: %zu", this->params.size());
-   for (size_t i = 0; i < this->params.size(); ++i) {
-      ESP_LOGD(TAG, "  [%zu] = %d", i, this->params[i]);
+   // only publish fields the gate actually reported, and leave fields with a
+   // pending change alone so the entities do not jump back in the meantime
+   const GateProParams &p = this->params;
+   auto publishable = [&](uint8_t idx) { return p.has(idx) && !this->param_changes_.has(idx); };
+   if (this->speed_slider && publishable(3))
+      this->speed_slider->publish_state(p[3]);
+   if (this->decel_dist_slider && publishable(4))
+      this->decel_dist_slider->publish_state(p[4]);
+   if (this->decel_speed_slider && publishable(5))
+      this->decel_speed_slider->publish_state(p[5]);
+   if (this->max_amp_slider && publishable(6))
+      this->max_amp_slider->publish_state(p[6]);
+   if (this->auto_close_slider && publishable(1))
+      this->auto_close_slider->publish_state(p[1]);
+   if (this->sw_permalock && publishable(15))
+      this->sw_permalock->publish_state(p[15]);
+   if (this->sw_infra1 && publishable(13))
+      this->sw_infra1->publish_state(p[13]);
+   if (this->sw_infra2 && publishable(14))
+      this->sw_infra2->publish_state(p[14]);
+   if (this->small_gate_timer && publishable(7))
+      this->small_gate_timer->publish_state(p[7]);
+   if (this->force_detection_number && publishable(9))
+      this->force_detection_number->publish_state(p[9]);
+}
+
+void GatePro::parse_params(std::string_view frame) {
+   if (!GateProParams::decode(frame, &this->params)) {
+      ESP_LOGW(TAG, "Malformed params frame: %.*s", (int) frame.size(), frame.data());
+      this->metrics_.count(COUNTER_PARSE_FAILURES);
+      if (this->param_txn_waiting_() && this->param_txn_rp_sent_) {
+         this->param_txn_abort_("malformed RP answer");
+      }
+      return;
    }
 
+   ESP_LOGD(TAG, "Parsed current params, valid mask 0x%05X", (unsigned) this->params.valid);
+   for (uint8_t i = 0; i < GateProParams::COUNT; ++i) {
+      if (this->params.has(i)) {
+         ESP_LOGV(TAG, "  [%u] = %u", i, this->params[i]);
+      }
+   }
+
+   if (this->params.complete()) {
+      GateProCache cache = this->cache_;
+      memcpy(cache.params, this->params.values.data(), GateProParams::COUNT);
+      cache.params_known = true;
+      this->save_cache_(cache);
+   }
+
+   // answers to RPs sent before the transaction's own are not its answer
+   if (this->param_txn_rp_sent_) {
+      if (this->param_txn_ == PARAM_TXN_READING) {
+         this->param_txn_read_();
+      } else if (this->param_txn_ == PARAM_TXN_VERIFYING) {
+         this->param_txn_verify_();
+      }
+   }
    this->publish_params();
+}
 
-   // write new params if any task is up
-   while (!this->paramTaskQueue.empty()) {
-      auto task = this->paramTaskQueue.front();
-      this->paramTaskQueue.pop();
-      task();
-      this->param_no_pub = false;
+bool GatePro::write_params() {
+   // a WP frame rewrites every field, never send one built from guesses
+   if (!this->params.complete()) {
+      ESP_LOGW(TAG, "Not writing params, only mask 0x%05X of the fields is known",
+               (unsigned) this->params.valid);
+      return false;
    }
+   GateProRequest request{GATEPRO_CMD_WRITE_PARAMS, millis(), this->params};
+   ESP_LOGD(TAG, "BUILT PARAMS: %s", this->request_text_(request));
+   // the verify RP follows from handle_write_ack_()
+   return this->tx_queue.push(request);
 }
 
-void GatePro::write_params() {
-   std::string msg = "WP,1:";
-   for (size_t i = 0; i < this->params.size(); i++) {
-      msg += std::to_string(this->params[i]);
-      if (i != this->params.size() -1) {
-         msg += ",";
+////////////////////////////////////////////
+// Flash cache
+////////////////////////////////////////////
+void GatePro::load_cache_() {
+   this->cache_pref_ = global_preferences->make_preference<GateProCache>(this->get_object_id_hash(), true);
+   GateProCache cache;
+   if (!this->cache_pref_.load(&cache) || cache.version != GateProCache::VERSION) {
+      ESP_LOGD(TAG, "No cached params");
+      memset(&this->cache_, 0, sizeof(this->cache_));
+      this->cache_.version = GateProCache::VERSION;
+      this->cache_.coast[0] = this->stop_planner_.coast(1);
+      this->cache_.coast[1] = this->stop_planner_.coast(-1);
+      return;
+   }
+   this->cache_ = cache;
+   this->cache_.devinfo[sizeof(this->cache_.devinfo) - 1] = '\0';
+   memset(this->cache_.reserved, 0, sizeof(this->cache_.reserved));
+   this->stop_planner_.set_coast(1, std::min(cache.coast[0], StopPlanner::MAX_COAST));
+   this->stop_planner_.set_coast(-1, std::min(cache.coast[1], StopPlanner::MAX_COAST));
+   this->patterns_.load(cache.patterns);
+
+   // publish the cached values right away, the boot RP confirms them later
+   if (cache.params_known) {
+      for (uint8_t i = 0; i < GateProParams::COUNT; i++) {
+         this->params.set(i, cache.params[i]);
       }
+      ESP_LOGD(TAG, "Restored cached params");
+      this->publish_params();
    }
-   ESP_LOGD(TAG, "BUILT PARAMS: %s", msg.c_str());
-   this->tx_queue.push(msg);
+   if (this->txt_devinfo && this->cache_.devinfo[0] != '\0') {
+      this->txt_devinfo->publish_state(this->cache_.devinfo);
+   }
+}
 
-   // read params again just to update frontend and make sure :)
-   this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS);
+void GatePro::save_patterns_(uint32_t now) {
+   // a learned pattern is confirmed on every open/close cycle, spare the flash
+   if (!this->patterns_dirty_ || (this->patterns_saved_ && now - this->patterns_saved_at_ < PATTERN_SAVE_INTERVAL)) {
+      return;
+   }
+   GateProCache cache = this->cache_;
+   memcpy(cache.patterns, this->patterns_.entries(), sizeof(cache.patterns));
+   this->save_cache_(cache);
+   this->patterns_dirty_ = false;
+   this->patterns_saved_ = true;
+   this->patterns_saved_at_ = now;
+}
+
+void GatePro::save_cache_(const GateProCache &cache) {
+   // spare the flash, only write what actually changed
+   if (memcmp(&cache, &this->cache_, sizeof(cache)) == 0) {
+      return;
+   }
+   this->cache_ = cache;
+   if (!this->cache_pref_.save(&this->cache_)) {
+      ESP_LOGW(TAG, "Failed to save the param cache");
+      return;
+   }
+   ESP_LOGD(TAG, "Saved param cache");
 }
 
 ////////////////////////////////////////////
@@ -754,14 +1419,15 @@ void GatePro::setup() {
    this->force_state_update_ = true;
    this->consecutive_position_readings_ = 0;
    this->last_position_reading_ = -1.0f;
-   this->last_pattern_seen_ = "";
-   this->consecutive_pattern_readings_ = 0;
-   this->msg_buff = "";
+   this->rx_framer_.clear();
+   this->build_command_frames_();
+   this->capture_.init(this->capture_size_);
+   this->load_cache_();
    this->queue_gatepro_cmd(GATEPRO_CMD_READ_STATUS);
    this->blocker = false;
    this->target_position_ = 0.0f;
 
-   // Initialize parameter system
+   // Initialize parameter system, this also checks the cached values
    this->queue_gatepro_cmd(GATEPRO_CMD_READ_PARAMS);
    this->queue_gatepro_cmd(GATEPRO_CMD_DEVINFO);
    this->queue_gatepro_cmd(GATEPRO_CMD_READ_LEARN_STATUS);
@@ -805,12 +1471,18 @@ void GatePro::setup() {
          this->queue_gatepro_cmd(GATEPRO_CMD_REMOTE_LEARN);
       });
    }
+   if (this->btn_dump_trace) {
+      this->btn_dump_trace->add_on_press_callback([this]() { this->dump_trace(); });
+   }
+   if (this->btn_dump_capture) {
+      this->btn_dump_capture->add_on_press_callback([this]() { this->dump_capture(); });
+   }
    
    // Set up number slider callbacks
    if (this->speed_slider) {
       this->speed_slider->add_on_state_callback([this](float value){
          int int_value = (int)value;
-         if (this->params.size() > 3 && this->params[3] == int_value) {
+         if (this->params.has(3) && this->params[3] == int_value) {
             return;
          }
          // Group 4: 0-3 (1=default, 1=50%, 2=70%, 3=85%, 4=100%)
@@ -821,7 +1493,7 @@ void GatePro::setup() {
    if (this->decel_dist_slider) {
       this->decel_dist_slider->add_on_state_callback([this](float value){
          int int_value = (int)value;
-         if (this->params.size() > 4 && this->params[4] == int_value) {
+         if (this->params.has(4) && this->params[4] == int_value) {
             return;
          }
          // Group 5: 0-4 (1=default, 1=75%, 2=80%, 3=85%, 4=90%, 5=95%)
@@ -832,7 +1504,7 @@ void GatePro::setup() {
    if (this->decel_speed_slider) {
       this->decel_speed_slider->add_on_state_callback([this](float value){
          int int_value = (int)value;
-         if (this->params.size() > 5 && this->params[5] == int_value) {
+         if (this->params.has(5) && this->params[5] == int_value) {
             return;
          }
          // Group 6: 0-3 (1=default, 1=80%, 2=60%, 3=40%, 4=25%)
@@ -843,7 +1515,7 @@ void GatePro::setup() {
    if (this->max_amp_slider) {
       this->max_amp_slider->add_on_state_callback([this](float value){
          int int_value = (int)value;
-         if (this->params.size() > 6 && this->params[6] == int_value) {
+         if (this->params.has(6) && this->params[6] == int_value) {
             return;
          }
          // Group 7: 0-9 (1=default, 1=2A, 2=3A, 3=4A, 4=5A, 5=6A, 6=7A, 7=8A, 8=9A, 9=10A, A=11A, C=12A, E=13A)
@@ -854,7 +1526,7 @@ void GatePro::setup() {
    if (this->auto_close_slider) {
       this->auto_close_slider->add_on_state_callback([this](float value){
          int int_value = (int)value;
-         if (this->params.size() > 1 && this->params[1] == int_value) {
+         if (this->params.has(1) && this->params[1] == int_value) {
             return;
          }
          // Group 2: 0-8 (0=disabled, 1=5s, 2=15s, 3=30s, 4=45s, 5=60s, 6=80s, 7=120s, 8=180s)
@@ -865,7 +1537,7 @@ void GatePro::setup() {
    // Set up switch callbacks
    if (this->sw_permalock) {
       this->sw_permalock->add_on_state_callback([this](bool state){
-         if (this->params.size() > 15 && this->params[15] == (state ? 1 : 0)) {
+         if (this->params.has(15) && this->params[15] == (state ? 1 : 0)) {
             return;
          }
          // Group L: L-0: disabled, L-1: enabled
@@ -876,7 +1548,7 @@ void GatePro::setup() {
    // infra1
   if (this->sw_infra1) {
     this->sw_infra1->add_on_state_callback([this](bool state){
-        if (this->params.size() > 13 && this->params[13] == (state ? 1 : 0)) {
+        if (this->params.has(13) && this->params[13] == (state ? 1 : 0)) {
           return;
         }
         // Group H: H-0: disabled, H-1: enabled
@@ -887,7 +1559,7 @@ void GatePro::setup() {
    // infra2
    if (this->sw_infra2) {
     this->sw_infra2->add_on_state_callback([this](bool state){
-      if (this->params.size() > 14 && this->params[14] == (state ? 1 : 0)) {
+      if (this->params.has(14) && this->params[14] == (state ? 1 : 0)) {
         return;
       }
       // Group J: J-0: disabled, J-1: enabled
@@ -899,7 +1571,7 @@ void GatePro::setup() {
   if (this->small_gate_timer) {
       this->small_gate_timer->add_on_state_callback([this](float value){
         int int_value = (int)value;
-        if (this->params.size() > 7 && this->params[7] == int_value) {
+        if (this->params.has(7) && this->params[7] == int_value) {
             return;
         }
         // Group 8: 1-6 (1=3s, 2=6s, 3=9s, 4=12s, 5=15s, 6=18s)
@@ -911,7 +1583,7 @@ void GatePro::setup() {
    if (this->force_detection_number) {
     this->force_detection_number->add_on_state_callback([this](float value){
         int int_value = (int)value;
-        if (this->params.size() > 9 && this->params[9] == int_value) {
+        if (this->params.has(9) && this->params[9] == int_value) {
             return;
         }
        // Group A: 0-3 (0=disabled, 1=Stop + reverse 1mp, 2=Stop + reverse 3mp, 3=Stop + reverse to end)
@@ -921,36 +1593,199 @@ void GatePro::setup() {
 }
 
 void GatePro::update() {
-  uint32_t now = millis();
-  
-  // Always publish the current state to ensure ESPHome stays in sync
+  // Publish whatever the policy lets through, e.g. the idle heartbeat
   this->publish();
   
   // Check if we need to stop at target position
   this->stop_at_target_position();
-  
-  // Process any pending UART messages
-  this->write_uart();
 
-  // If we're in an unknown state or if we need to force an update
-  if (this->gate_state_ == STATE_UNKNOWN || 
-      this->force_state_update_ || 
-      this->current_operation != cover::COVER_OPERATION_IDLE) {
-    this->queue_gatepro_cmd(GATEPRO_CMD_READ_STATUS);
-    this->force_state_update_ = false;
+  this->correction_after_operation();
+
+  this->save_patterns_(millis());
+
+  this->publish_metrics_();
+}
+
+bool GatePro::poll_due_(uint32_t now) const {
+  // Poll fast while the gate moves, slowly while it is idle. Motor events
+  // switch between the two as soon as they arrive. Until a first status has
+  // been decoded the state is unknown, so a lost boot poll is retried fast.
+  // The pattern table learns from the status right after the gate came to
+  // rest, which also needs fast polls until it has been read.
+  bool moving = this->current_operation != cover::COVER_OPERATION_IDLE ||
+                this->gate_state_ == STATE_OPENING || this->gate_state_ == STATE_CLOSING ||
+                (this->gate_state_ == STATE_UNKNOWN && !this->status_seen_) || this->patterns_.learning(now);
+  uint32_t interval = moving ? this->moving_poll_interval_ : this->idle_poll_interval_;
+  return this->force_state_update_ || now - this->last_poll_ >= interval;
+}
+
+void GatePro::poll_status_(uint32_t now) {
+  // with several gates the bus spreads the polls out
+  if (!this->poll_due_(now) || (this->bus_ && !this->bus_->grant_poll(this, now))) {
+    return;
   }
+  this->queue_gatepro_cmd(GATEPRO_CMD_READ_STATUS);
+  this->last_poll_ = now;
+  this->force_state_update_ = false;
+}
 
-  this->correction_after_operation();
+void GatePro::poll_now_() {
+  this->force_state_update_ = true;
 }
 
-void GatePro::loop() {
-  // keep reading uart for changes
+void GatePro::receive_() {
+  // Frame and dispatch everything that is ready while the loop budget lasts.
+  // On a shared UART the bus hands each frame to the gate it belongs to.
+  uint32_t start = micros();
   this->read_uart();
-  this->process();
+  std::string_view frame;
+  bool dispatched = false;
+  while (true) {
+    if (!this->rx_framer_.peek_frame(&frame)) {
+      // the ring may have filled up, fetch what is left in the UART FIFO
+      if (this->available() <= 0) {
+        break;
+      }
+      this->read_uart();
+      if (!this->rx_framer_.peek_frame(&frame)) {
+        break;
+      }
+    }
+    // the first frame is always handled, so a slow one cannot block the rest
+    if (dispatched && micros() - start >= this->loop_budget_us_) {
+      break;
+    }
+    if (this->bus_) {
+      this->bus_->dispatch(this, frame);
+    } else {
+      this->process(frame);
+    }
+    this->rx_framer_.pop_frame();
+    dispatched = true;
+  }
+
+  uint32_t elapsed = micros() - start;
+  if (elapsed > this->loop_budget_us_) {
+    this->metrics_.count(COUNTER_LOOP_OVERRUNS);
+    uint32_t now = millis();
+    if (now - this->last_overrun_log_ >= OVERRUN_LOG_INTERVAL) {
+      this->last_overrun_log_ = now;
+      ESP_LOGW(TAG, "Receiving took %uus, loop budget %uus (%u overruns)", elapsed, this->loop_budget_us_,
+               this->get_counter(COUNTER_LOOP_OVERRUNS));
+    }
+  }
+  // bytes still waiting, in the ring and in the UART FIFO
+  uint32_t backlog = this->rx_framer_.size() + std::max(this->available(), 0);
+  if (this->metrics_.add_rx_backlog(backlog)) {
+    ESP_LOGV(TAG, "New RX backlog peak: %u bytes", backlog);
+  }
+}
+
+void GatePro::set_bus(GateProBus *bus) {
+  this->bus_ = bus;
+  bus->add_gate(this);
+}
+
+void GatePro::loop() {
+  // on a shared UART only one of the gates reads it
+  if (!this->bus_ || this->bus_->reads(this)) {
+    this->receive_();
+  }
+
+  // Poll the status at the rate matching the gate's motion
+  uint32_t now = millis();
+  this->poll_status_(now);
+
+  // Move the position along between RS samples
+  this->interpolate_position_(now);
+
+  // Push state changes held back by the publish policy
+  this->publish();
+
+  // Start a parameter transaction once its commit window has closed
+  this->param_txn_loop_(now);
+
+  // Send the next queued command as soon as the bus is free
+  this->write_uart();
+}
+
+void GatePro::dump_trace() { this->trace_ring_.dump(TAG); }
+
+void GatePro::dump_capture() {
+  if (!this->capture_.enabled()) {
+    ESP_LOGW(TAG, "UART capture is disabled, set capture_size to enable it");
+    return;
+  }
+  this->capture_.dump(TAG);
+}
+
+uint32_t GatePro::get_counter(GateProCounter counter) const {
+  // the queue counts its own drops, they happen inside push()
+  if (counter == COUNTER_QUEUE_DROPS) {
+    return this->tx_queue.drops();
+  }
+  return this->metrics_.counters[counter];
+}
+
+void GatePro::publish_metrics_() {
+  for (uint8_t i = 0; i < COUNTER_COUNT; i++) {
+    sensor::Sensor *sens = this->counter_sensors[i];
+    float value = this->get_counter((GateProCounter) i);
+    if (sens && (!sens->has_state() || sens->state != value)) {
+      sens->publish_state(value);
+    }
+  }
+  for (uint8_t i = 0; i < LATENCY_COUNT; i++) {
+    sensor::Sensor *sens = this->latency_sensors[i];
+    const LatencyHistogram &histogram = this->metrics_.latencies[i];
+    if (!sens || histogram.count() == 0) {
+      continue;
+    }
+    float value = histogram.percentile(95);
+    if (!sens->has_state() || sens->state != value) {
+      sens->publish_state(value);
+    }
+  }
+  // the backlog sensor reports the peak of each update interval
+  if (this->rx_backlog_sensor) {
+    float value = this->metrics_.rx_backlog_peak;
+    if (!this->rx_backlog_sensor->has_state() || this->rx_backlog_sensor->state != value) {
+      this->rx_backlog_sensor->publish_state(value);
+    }
+  }
+  this->metrics_.reset_rx_backlog();
 }
 
 void GatePro::dump_config(){
     ESP_LOGCONFIG(TAG, "GatePro sensor dump config");
+    ESP_LOGCONFIG(TAG, "  Inter-frame gap: %ums", this->inter_frame_gap_);
+    if (this->bus_) {
+      ESP_LOGCONFIG(TAG, "  On a multi-gate bus, event source: %s",
+                    this->event_source_.empty() ? "any" : this->event_source_.c_str());
+    }
+    ESP_LOGCONFIG(TAG, "  Poll interval: %ums moving, %ums idle", this->moving_poll_interval_,
+                  this->idle_poll_interval_);
+    ESP_LOGCONFIG(TAG, "  Param commit window: %ums", this->param_commit_window_);
+    ESP_LOGCONFIG(TAG, "  State: %u RS patterns without an event, events lead for %ums",
+                  this->estimator_.confirmations(), this->estimator_.timeout());
+    ESP_LOGCONFIG(TAG, "  Learned status patterns: %zu", this->patterns_.learned());
+    if (this->capture_.enabled()) {
+      ESP_LOGCONFIG(TAG, "  UART capture: %zu bytes", this->capture_.capacity());
+    }
+    ESP_LOGCONFIG(TAG, "  Publish: delta %.2f, every %ums while moving, heartbeat %ums", this->publish_delta_,
+                  this->moving_publish_interval_, this->heartbeat_interval_);
+    ESP_LOGCONFIG(TAG, "  Frames: %u in, %u out, %u parse failures", this->get_counter(COUNTER_FRAMES_IN),
+                  this->get_counter(COUNTER_FRAMES_OUT), this->get_counter(COUNTER_PARSE_FAILURES));
+    ESP_LOGCONFIG(TAG, "  Drops: %u TX queue, %u RX overflows", this->get_counter(COUNTER_QUEUE_DROPS),
+                  this->get_counter(COUNTER_RX_OVERFLOWS));
+    ESP_LOGCONFIG(TAG, "  Loop budget: %uus, %u overruns, RX backlog peak %u bytes", this->loop_budget_us_,
+                  this->get_counter(COUNTER_LOOP_OVERRUNS), this->get_rx_backlog_peak());
+    for (uint8_t i = 0; i < LATENCY_COUNT; i++) {
+      const LatencyHistogram &histogram = this->metrics_.latencies[i];
+      ESP_LOGCONFIG(TAG, "  %s latency: %u samples, p50 %ums, p90 %ums, p99 %ums, max %ums",
+                    GateProMetrics::latency_name((GateProLatency) i), histogram.count(), histogram.percentile(50),
+                    histogram.percentile(90), histogram.percentile(99), histogram.max());
+    }
 }
 
 }  // namespace gatepro
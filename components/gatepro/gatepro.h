@@ -1,10 +1,12 @@
 #pragma once
 
-#include <map>
-#include <queue>
+#include <array>
+#include <memory>
+#include <string_view>
 #include <vector>
 #include "esphome.h"
 #include "esphome/core/component.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/uart/uart.h"
 #include "esphome/components/cover/cover.h"
 #include "esphome/components/sensor/sensor.h"
@@ -12,6 +14,14 @@
 #include "esphome/components/button/button.h"
 #include "esphome/components/number/number.h"
 #include "esphome/components/switch/switch.h"
+#include "metrics.h"
+#include "motion_model.h"
+#include "rx_framer.h"
+#include "pattern_table.h"
+#include "state_estimator.h"
+#include "stop_planner.h"
+#include "trace_ring.h"
+#include "uart_capture.h"
 
 namespace esphome {
 namespace gatepro {
@@ -31,6 +41,7 @@ enum GateProCmd : uint8_t {
    GATEPRO_CMD_RESTORE, // untested
    GATEPRO_CMD_PED_OPEN, // untested
    GATEPRO_CMD_READ_FUNCTION, // untested
+   GATEPRO_CMD_COUNT,
 };
 
 enum GateProState : uint8_t {
@@ -42,27 +53,163 @@ enum GateProState : uint8_t {
   STATE_STOPPED
 };
 
-// Forward declaration of the GatePro class
-class GatePro;
+// Acknowledgement a request is answered with. Commands that the controller
+// does not acknowledge are sent fire-and-forget (GATEPRO_ACK_NONE).
+enum GateProAck : uint8_t {
+  GATEPRO_ACK_NONE,
+  GATEPRO_ACK_RS,
+  GATEPRO_ACK_RP,
+  GATEPRO_ACK_WP,
+  GATEPRO_ACK_DEVINFO,
+  GATEPRO_ACK_LEARN_STATUS,
+  GATEPRO_ACK_COUNT,
+};
+
+// Decoded ACK RS status frame, e.g. "ACK RS:00,80,C4,C6,3E,16,FF,FF,FF"
+struct GateProStatus {
+  static const uint8_t SIZE = 9;
+  // bytes 1-4 of a closed and of a fully open gate
+  static const uint32_t PATTERN_CLOSED = 0xA2004000;
+  static const uint32_t PATTERN_OPEN = 0xA2E34000;
+  static const uint32_t POSITION_MASK = 0x00007F00;  // see position_percent()
+
+  uint8_t bytes[SIZE]{};
+  uint8_t count{0};  // bytes present in the frame
+
+  // Single pass, allocation-free decoder. Returns false on malformed frames.
+  static bool decode(std::string_view frame, GateProStatus *status);
+
+  // bytes 1-4 packed big-endian, identifies the gate's end state
+  uint32_t pattern() const {
+    return (uint32_t(bytes[1]) << 24) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 8) | bytes[4];
+  }
+  // pattern() without the position bits of byte 3, what the PatternTable learns
+  uint32_t signature() const { return this->pattern() & ~POSITION_MASK; }
+  // travel position in percent
+  uint8_t position_percent() const;
+};
 
+// Decoded ACK RP parameter frame, e.g. "ACK RP,1:1,0,0,1,2,2,0,0,0,3,0,0,3,0,0,0,0".
+// Each field is a single hex digit on the wire (max amp uses A/C/E), two-digit
+// hex fields are accepted as well. Fields missing from the frame stay invalid.
+struct GateProParams {
+  static const uint8_t COUNT = 17;
+  static const uint32_t ALL_VALID = (1u << COUNT) - 1;
+  // "WP,1:" plus up to two digits and a separator per field
+  static const size_t MAX_FRAME = 5 + COUNT * 3;
+
+  std::array<uint8_t, COUNT> values{};
+  uint32_t valid{0};  // bit i set when values[i] was read from the gate
+
+  // Single pass, bounds-checked, allocation-free decoder.
+  // Returns false on malformed frames and leaves *params untouched.
+  static bool decode(std::string_view frame, GateProParams *params);
+  // Writes the WP frame into buf, returns its length or 0 if a field is unknown
+  size_t encode(char *buf, size_t len) const;
+
+  bool has(uint8_t idx) const { return idx < COUNT && (this->valid & (1u << idx)); }
+  bool complete() const { return this->valid == ALL_VALID; }
+  void set(uint8_t idx, uint8_t value) {
+    this->values[idx] = value;
+    this->valid |= 1u << idx;
+  }
+  uint8_t operator[](uint8_t idx) const { return this->values[idx]; }
+};
+
+// A command waiting in the TX queue. Plain data, the frame is only built
+// when the request is written to the UART.
+struct GateProRequest {
+  GateProCmd cmd;
+  uint32_t queued_at{0};
+  GateProParams params{};  // GATEPRO_CMD_WRITE_PARAMS: the values to write
+};
+
+// A sent request waiting for its acknowledgement
+struct GateProInFlight {
+  bool active{false};
+  bool retry_due{false};
+  GateProRequest request;
+  uint32_t first_sent_at{0};  // first attempt, ACK latency is measured from here
+  uint32_t sent_at{0};        // latest attempt, the timeout runs from here
+  uint32_t timeout{0};
+  uint8_t attempts{0};
+};
 
-// Command templates - will be formatted with source parameter
-const std::map<GateProCmd, const char*> GateProCmdTemplates = {
-   {GATEPRO_CMD_OPEN, "FULL OPEN;src=%s"},
-   {GATEPRO_CMD_CLOSE, "FULL CLOSE;src=%s"},
-   {GATEPRO_CMD_STOP, "STOP;src=%s"},
-   {GATEPRO_CMD_READ_STATUS, "RS;src=%s"},
-   {GATEPRO_CMD_READ_PARAMS, "RP,1:;src=%s"},
-   {GATEPRO_CMD_WRITE_PARAMS, "WP,1:"},  // No source needed for write params
-   {GATEPRO_CMD_LEARN, "AUTO LEARN;src=%s"},
-   {GATEPRO_CMD_DEVINFO, "READ DEVINFO;src=%s"},
-   {GATEPRO_CMD_READ_LEARN_STATUS, "READ LEARN STATUS;src=%s"},
-   {GATEPRO_CMD_REMOTE_LEARN, "REMOTE LEARN;src=%s"},
-   {GATEPRO_CMD_CLEAR_REMOTE_LEARN, "CLEAR REMOTE LEARN;src=%s"},
-   {GATEPRO_CMD_RESTORE, "RESTORE;src=%s"},
-   {GATEPRO_CMD_PED_OPEN, "PED OPEN;src=%s"},
-   {GATEPRO_CMD_READ_FUNCTION, "READ FUNCTION;src=%s"},
+// Last confirmed parameters, device info and what was learned about the gate, kept in flash so the entities
+// can be published at boot before the gate has answered
+struct GateProCache {
+  static const uint32_t VERSION = 3;
+  uint32_t version;
+  uint8_t params[GateProParams::COUNT];
+  bool params_known;
+  char devinfo[48];
+  uint16_t coast[2];  // learned STOP coast time, opening and closing
+  uint8_t reserved[2];  // always zero, keeps patterns aligned without padding
+  PatternEntry patterns[PatternTable::SLOTS];  // learned RS status signatures
 };
+// save_cache_() compares caches with memcmp(), so every byte must be a member
+static_assert(sizeof(GateProCache) == 4 + GateProParams::COUNT + 1 + 48 + 2 * 2 + 2 +
+                                          PatternTable::SLOTS * sizeof(PatternEntry),
+              "GateProCache must not have padding");
+
+// Parameter transaction phases, see GatePro::set_param()
+enum GateProParamTxn : uint8_t {
+  PARAM_TXN_IDLE,
+  PARAM_TXN_COLLECTING,  // changes are merged until the commit window closes
+  PARAM_TXN_READING,     // RP sent, the WP is built from its answer
+  PARAM_TXN_VERIFYING,   // WP sent, waiting for its ACK and then the verify RP
+};
+
+// Send priority of a command, lower values are sent first
+enum GateProPriority : uint8_t {
+  GATEPRO_PRIORITY_STOP,
+  GATEPRO_PRIORITY_MOTION,
+  GATEPRO_PRIORITY_CONFIG,
+  GATEPRO_PRIORITY_READ,
+};
+
+// Small fixed-capacity TX queue ordered by priority, FIFO within a priority.
+// - STOP cancels queued motion commands and jumps ahead of everything else
+// - a new OPEN/CLOSE replaces a queued one, the latest motion request wins
+// - reads and parameter writes that are already queued are coalesced
+// - when full, the lowest-priority entry is dropped, never STOP or motion
+// The entries are allocated once, pushing and erasing never allocates.
+class GateProCommandQueue {
+ public:
+  static constexpr size_t DEFAULT_CAPACITY = 10;
+  // STOP, one motion command and a read must always fit
+  static constexpr size_t MIN_CAPACITY = 3;
+
+  explicit GateProCommandQueue(size_t capacity = DEFAULT_CAPACITY) { this->init(capacity); }
+  // Reallocates the entries and empties the queue, meant for configuration
+  void init(size_t capacity);
+
+  static GateProPriority priority(GateProCmd cmd);
+
+  // Returns false if the request was dropped
+  bool push(const GateProRequest &request);
+  const GateProRequest &operator[](size_t index) const { return this->entries_[index]; }
+  void erase(size_t index);
+  void clear() { this->size_ = 0; }
+  size_t size() const { return this->size_; }
+  size_t capacity() const { return this->capacity_; }
+  bool empty() const { return this->size_ == 0; }
+  // Requests dropped because the queue was full
+  uint32_t drops() const { return this->drops_; }
+
+ protected:
+  int find_(GateProCmd cmd) const;
+
+  std::unique_ptr<GateProRequest[]> entries_;
+  size_t capacity_{0};
+  size_t size_{0};
+  uint32_t drops_{0};
+};
+
+// Forward declaration of the GatePro class
+class GatePro;
+class GateProBus;
+
 
 class GatePro : public cover::Cover, public PollingComponent, public uart::UARTDevice {
  public:
@@ -83,18 +230,32 @@ class GatePro : public cover::Cover, public PollingComponent, public uart::UARTD
       void set_sw_infra2(switch_::Switch *sw) { sw_infra2 = sw; }
       
       // Button components
-      esphome::button::Button *btn_learn;
+      esphome::button::Button *btn_learn{nullptr};
       void set_btn_learn(esphome::button::Button *btn) { btn_learn = btn; }
-      esphome::button::Button *btn_params_od;
+      esphome::button::Button *btn_params_od{nullptr};
       void set_btn_params_od(esphome::button::Button *btn) { btn_params_od = btn; }
-      esphome::button::Button *btn_remote_learn;
+      esphome::button::Button *btn_remote_learn{nullptr};
       void set_btn_remote_learn(esphome::button::Button *btn) { btn_remote_learn = btn; }
+      esphome::button::Button *btn_dump_trace{nullptr};
+      void set_btn_dump_trace(esphome::button::Button *btn) { btn_dump_trace = btn; }
+      esphome::button::Button *btn_dump_capture{nullptr};
+      void set_btn_dump_capture(esphome::button::Button *btn) { btn_dump_capture = btn; }
       
       // Text sensor components
       text_sensor::TextSensor *txt_devinfo{nullptr};
       void set_txt_devinfo(esphome::text_sensor::TextSensor *txt) { txt_devinfo = txt; }
       text_sensor::TextSensor *txt_learn_status{nullptr};
       void set_txt_learn_status(esphome::text_sensor::TextSensor *txt) { txt_learn_status = txt; }
+      text_sensor::TextSensor *txt_status{nullptr};
+      void set_txt_status(esphome::text_sensor::TextSensor *txt) { txt_status = txt; }
+
+      // Diagnostic sensors: protocol counters and the 95th latency percentile in ms
+      sensor::Sensor *counter_sensors[COUNTER_COUNT]{};
+      void set_counter_sensor(GateProCounter counter, sensor::Sensor *sens) { counter_sensors[counter] = sens; }
+      sensor::Sensor *latency_sensors[LATENCY_COUNT]{};
+      void set_latency_sensor(GateProLatency latency, sensor::Sensor *sens) { latency_sensors[latency] = sens; }
+      sensor::Sensor *rx_backlog_sensor{nullptr};
+      void set_rx_backlog_sensor(sensor::Sensor *sens) { rx_backlog_sensor = sens; }
 
       // Number slider components
       number::Number *speed_slider{nullptr};
@@ -123,19 +284,73 @@ class GatePro : public cover::Cover, public PollingComponent, public uart::UARTD
   
   // Set the source parameter for commands
   void set_source(const std::string &source) { this->source_ = source; }
+
+  // Several gates on one node: polls and, on a shared UART, bus access are
+  // arbitrated by the bus. Motor events are routed by their src= code.
+  void set_bus(GateProBus *bus);
+  void set_event_source(const std::string &source) { this->event_source_ = source; }
+
+  // Minimum idle time on the bus between two frames
+  void set_inter_frame_gap(uint32_t gap_ms) { this->inter_frame_gap_ = gap_ms; }
+
+  // Status (RS) polling rates while the gate moves and while it is idle
+  void set_moving_poll_interval(uint32_t interval_ms) { this->moving_poll_interval_ = interval_ms; }
+  void set_idle_poll_interval(uint32_t interval_ms) { this->idle_poll_interval_ = interval_ms; }
+
+  // Buffer capacities, allocated once at boot so that the main loop never
+  // allocates: requests in the TX queue and bytes in the RX ring
+  void set_tx_queue_size(size_t requests) { this->tx_queue.init(requests); }
+  void set_rx_buffer_size(size_t bytes) { this->rx_framer_.init(bytes); }
+
+  // CPU time loop() may spend framing and dispatching received frames. Frames
+  // that do not fit wait for the next loop(), at least one is always handled.
+  void set_loop_budget(uint32_t budget_us) { this->loop_budget_us_ = budget_us; }
+
+  // RS status patterns needed to settle the end state without a motor event,
+  // and how long after an event disagreeing patterns are ignored
+  void set_state_confirmations(uint8_t confirmations) { this->estimator_.set_confirmations(confirmations); }
+  void set_state_timeout(uint32_t timeout_ms) { this->estimator_.set_timeout(timeout_ms); }
+
+  // How long set_param() changes are collected before they are written together
+  void set_param_commit_window(uint32_t window_ms) { this->param_commit_window_ = window_ms; }
+
+  // Cover state publishing: operation changes go out immediately, position
+  // changes of at least publish_delta at most every moving_publish_interval,
+  // and an optional heartbeat re-publishes an unchanged idle state
+  void set_publish_delta(float delta) { this->publish_delta_ = delta; }
+  void set_moving_publish_interval(uint32_t interval_ms) { this->moving_publish_interval_ = interval_ms; }
+  void set_heartbeat_interval(uint32_t interval_ms) { this->heartbeat_interval_ = interval_ms; }
   
-  // Get formatted command string with source parameter
-  std::string get_command_string(GateProCmd cmd);
+  // Frame of a fixed command, with the source but without the delimiter.
+  // Empty before setup() and for WP, whose frame depends on the values.
+  std::string_view get_command_string(GateProCmd cmd) const;
+
+  // Logs the recent protocol events kept in the trace ring
+  void dump_trace();
+
+  // Raw UART capture for replay on the host, off unless a size is set
+  void set_capture_size(size_t bytes) { this->capture_size_ = bytes; }
+  // Logs the capture as hex lines, see UartCapture
+  void dump_capture();
+  const UartCapture &get_capture() const { return this->capture_; }
+
+  // Last decoded status (ACK RS) frame
+  const GateProStatus &get_status() const { return this->status_; }
+
+  // Protocol counters and latency histograms
+  uint32_t get_counter(GateProCounter counter) const;
+  const LatencyHistogram &get_latency(GateProLatency latency) const { return this->metrics_.latencies[latency]; }
+  // Peak RX backlog in bytes since the last update(), which publishes and resets it
+  uint32_t get_rx_backlog_peak() const { return this->metrics_.rx_backlog_peak; }
 
  protected:
+  friend class GateProBus;
+
       // Parameter logic
-      std::vector<int> params;
-      void parse_params(std::string msg);
-      bool param_no_pub = false;
+      GateProParams params;
+      void parse_params(std::string_view msg);
       void publish_params();
-      void write_params();
-      std::queue<std::function<void()>> paramTaskQueue;
-      std::string devinfo = "N/A";
+      bool write_params();
 
   void update_state_from_position(float position);
   void log_state_change(GateProState old_state, GateProState new_state);
@@ -145,32 +360,122 @@ class GatePro : public cover::Cover, public PollingComponent, public uart::UARTD
   void start_direction_(cover::CoverOperation dir);
 
   // device logic
-  std::string convert(uint8_t*, size_t);
-  void process();
-  void queue_gatepro_cmd(GateProCmd cmd);
+  std::string convert(const uint8_t*, size_t);
+  void process(std::string_view msg);
+
+  // frame handlers, selected by FRAME_HANDLERS
+  struct FrameHandler {
+    std::string_view prefix;
+    GateProAck ack;  // acknowledgement this frame completes
+    void (GatePro::*handler)(std::string_view msg);
+  };
+  static const FrameHandler FRAME_HANDLERS[];
+  // the frame's handler entry, nullptr for unknown frames
+  static const FrameHandler *frame_handler_(std::string_view msg);
+  void handle_status_(std::string_view msg);
+  void publish_status_(const GateProStatus &status);
+  void handle_motor_event_(std::string_view msg);
+  void apply_motor_event_(GateProState state);
+  void handle_params_(std::string_view msg);
+  void handle_write_ack_(std::string_view msg);
+  void handle_devinfo_(std::string_view msg);
+  void handle_learn_status_(std::string_view msg);
+  bool queue_gatepro_cmd(GateProCmd cmd);
   void read_uart();
+  void receive_();
   void write_uart();
+  bool bus_free_(uint32_t now);
+  void send_request_(const GateProRequest &request, uint32_t now);
+  // Builds the request's frame, without the delimiter, into buf. Returns its
+  // length, 0 if it does not fit or the request has nothing to send.
+  size_t format_request_(const GateProRequest &request, char *buf, size_t len) const;
+  // The request's frame for logs and traces, valid until the next call
+  const char *request_text_(const GateProRequest &request);
+  void check_timeouts_(uint32_t now);
+  void complete_request_(GateProAck ack);
   void debug();
-  std::queue<std::string> tx_queue;
-  std::queue<std::string> rx_queue;
+  GateProCommandQueue tx_queue;
   bool blocker;
+
+  // Outstanding requests, at most one per acknowledgement type
+  GateProInFlight in_flight_[GATEPRO_ACK_COUNT];
+  static const uint8_t MAX_RETRIES = 2;
+  static constexpr uint32_t MAX_ACK_TIMEOUT = 4000;
+
+  // Parameter transactions: one RP -> WP -> RP cycle per batch of changes
+  void param_txn_loop_(uint32_t now);
+  void param_txn_enter_(GateProParamTxn phase);
+  void param_txn_read_();
+  void param_txn_verify_();
+  void param_txn_abort_(const char *reason);
+  bool param_txn_waiting_() const {
+    return this->param_txn_ == PARAM_TXN_READING || this->param_txn_ == PARAM_TXN_VERIFYING;
+  }
+  static constexpr uint32_t PARAM_TXN_TIMEOUT = 15000;  // ms for an RP, WP or verify RP to be answered
+  GateProParamTxn param_txn_{PARAM_TXN_IDLE};
+  uint32_t param_txn_deadline_{0};
+  bool param_txn_rp_sent_{false};  // the RP of the current phase is on the wire
+  GateProParams param_changes_;  // valid bits are the dirty mask
+  GateProParams param_written_;  // fields of the WP being verified
+  uint32_t param_commit_window_{250};
+  uint32_t param_commit_at_{0};
+
+  // Flash cache of params and devinfo, written only when its contents change
+  void load_cache_();
+  void save_cache_(const GateProCache &cache);
+  ESPPreferenceObject cache_pref_;
+  GateProCache cache_{};
+
+  // Status polling
+  void poll_status_(uint32_t now);
+  bool poll_due_(uint32_t now) const;
+  void poll_now_();
+  uint32_t moving_poll_interval_{500};
+  uint32_t idle_poll_interval_{60000};
+  uint32_t last_poll_{0};
+  bool status_seen_{false};  // a status frame has been decoded since boot
+
+  // TX pacing
+  uint32_t inter_frame_gap_{50};
+  uint32_t tx_busy_until_{0};  // when the last written frame has left the UART
+  uint32_t last_rx_{0};        // when the last byte was received
   
+  // Position between RS samples
+  void interpolate_position_(uint32_t now);
+  MotionModel motion_;
+  static constexpr float INTERPOLATION_STEP = 0.01f;  // smallest change worth publishing
+
+  // Partial moves, STOP is planned ahead of the target
+  uint32_t stop_latency_(uint32_t now) const;
+  void landed_(float position);
+  StopPlanner stop_planner_;
+
   // sensor logic
   void correction_after_operation();
   cover::CoverOperation last_operation_{cover::COVER_OPERATION_OPENING};
   void publish();
+  float publish_delta_{0.01f};
+  uint32_t moving_publish_interval_{500};
+  uint32_t heartbeat_interval_{0};  // 0 disables the heartbeat
+  bool published_{false};
+  float published_position_{0.0f};
+  cover::CoverOperation published_operation_{cover::COVER_OPERATION_IDLE};
+  uint32_t last_publish_{0};
   void stop_at_target_position();
 
   // UART parser constants
-  const std::string delimiter = "\\r\\n";
-  const uint8_t delimiter_length = delimiter.length();
-  const std::string tx_delimiter = "\r\n";
-  static const size_t MAX_UART_BUFFER_SIZE = 512;  // Maximum buffer size to prevent memory issues
-  static const size_t UART_READ_BUFFER_SIZE = 256; // Stack buffer size for reading
-  static const size_t MAX_QUEUE_SIZE = 10;         // Maximum queue size to prevent memory issues
-
-  const int known_percentage_offset = 128;
-  const float acceptable_diff = 0.05f;
+  static constexpr char TX_DELIMITER[] = "\r\n";
+  static constexpr size_t MAX_REQUEST_FRAME = 96;  // including the delimiter
+  char request_text_buf_[MAX_REQUEST_FRAME];
+
+  // Every fixed command frame, delimiter included, built once by setup() as
+  // the source never changes afterwards. Frame i is
+  // command_frames_[command_frame_at_[i]] up to command_frame_at_[i + 1].
+  void build_command_frames_();
+  std::string_view command_frame_(GateProCmd cmd) const;
+  std::unique_ptr<char[]> command_frames_;
+  uint16_t command_frame_at_[GATEPRO_CMD_COUNT + 1]{};
+
   float target_position_;
   float position_;
   bool operation_finished;
@@ -182,15 +487,46 @@ class GatePro : public cover::Cover, public PollingComponent, public uart::UARTD
   uint8_t consecutive_position_readings_{0};
   float last_position_reading_{-1.0f};
   
-  // Pattern detection variables
-  std::string last_pattern_seen_{""};
-  uint8_t consecutive_pattern_readings_{0};
+  // End state from motor events, confirmed by RS patterns
+  StateEstimator estimator_;
+  PatternTable patterns_;
+  // Learned patterns are written to flash by update(), at most once per interval
+  void save_patterns_(uint32_t now);
+  static constexpr uint32_t PATTERN_SAVE_INTERVAL = 3600000;  // ms
+  bool patterns_dirty_{false};
+  bool patterns_saved_{false};
+  uint32_t patterns_saved_at_{0};
+  GateProStatus status_;
   
-  // UART message buffer for stable message processing
-  std::string msg_buff{""};
+  // Recent protocol events, formatted only by dump_trace()
+  void trace_(GateProTraceEvent event, uint16_t arg, std::string_view data = {}) {
+    this->trace_ring_.record(micros(), event, arg, data);
+  }
+  TraceRing trace_ring_;
+
+  // Raw RX/TX bytes, recorded only while capture is enabled
+  UartCapture capture_;
+  size_t capture_size_{0};
+
+  // Raw RX byte ring, framed on "\r\n"
+  RxFramer rx_framer_;
+  uint32_t loop_budget_us_{2000};
+  uint32_t last_overrun_log_{0};
+  static const uint32_t OVERRUN_LOG_INTERVAL = 10000;
+
+  // Counters and latencies, published by update() and dumped by dump_config()
+  void publish_metrics_();
+  GateProMetrics metrics_;
+  uint32_t motion_sent_at_{0};
+  bool motion_pending_{false};  // OPEN/CLOSE written, waiting for the motor event
+  static const uint32_t MAX_MOTION_LATENCY = 10000;
   
   // Source parameter for commands (default value as fallback)
   std::string source_{"P00287D7"};
+
+  // Multi-gate arbitration, nullptr for a gate on its own
+  GateProBus *bus_{nullptr};
+  std::string event_source_;
 };
 
 }  // namespace gatepro
@@ -0,0 +1,175 @@
+#include "gatepro_bus.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace gatepro {
+
+static const char *const TAG = "gatepro.bus";
+
+void GateProBus::add_gate(GatePro *gate) {
+  if (this->count_ == MAX_GATES) {
+    ESP_LOGE(TAG, "At most %zu gates per bus", MAX_GATES);
+    return;
+  }
+  this->gates_[this->count_++] = gate;
+}
+
+void GateProBus::dump_config() {
+  ESP_LOGCONFIG(TAG, "GatePro bus");
+  ESP_LOGCONFIG(TAG, "  Gates: %zu", this->count_);
+  ESP_LOGCONFIG(TAG, "  Poll gap: %ums", this->poll_gap_);
+  for (size_t i = 0; i < this->count_; i++) {
+    const GatePro *gate = this->gates_[i];
+    ESP_LOGCONFIG(TAG, "  Gate %zu: src=%s, %s UART", i, gate->source_.c_str(), this->shared(gate) ? "shared" : "own");
+  }
+}
+
+int GateProBus::index_(const GatePro *gate) const {
+  for (size_t i = 0; i < this->count_; i++) {
+    if (this->gates_[i] == gate) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool GateProBus::same_uart_(const GatePro *a, const GatePro *b) const { return a->parent_ == b->parent_; }
+
+bool GateProBus::awaiting_ack_(const GatePro *gate) const {
+  for (const auto &slot : gate->in_flight_) {
+    if (slot.active) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GateProBus::shared(const GatePro *gate) const {
+  for (size_t i = 0; i < this->count_; i++) {
+    if (this->gates_[i] != gate && this->same_uart_(this->gates_[i], gate)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool GateProBus::reads(const GatePro *gate) const {
+  // the first gate registered on a UART reads it
+  for (size_t i = 0; i < this->count_; i++) {
+    if (this->same_uart_(this->gates_[i], gate)) {
+      return this->gates_[i] == gate;
+    }
+  }
+  return true;
+}
+
+void GateProBus::dispatch(GatePro *reader, std::string_view frame) {
+  if (!this->shared(reader)) {
+    reader->process(frame);
+    return;
+  }
+  const GatePro::FrameHandler *entry = GatePro::frame_handler_(frame);
+  if (entry != nullptr && entry->ack != GATEPRO_ACK_NONE) {
+    // an acknowledgement belongs to the gate waiting for it
+    for (size_t i = 0; i < this->count_; i++) {
+      GatePro *gate = this->gates_[i];
+      if (this->same_uart_(gate, reader) && gate->in_flight_[entry->ack].active) {
+        gate->process(frame);
+        return;
+      }
+    }
+    reader->process(frame);  // unsolicited
+    return;
+  }
+
+  static const std::string_view MOTOR_EVENT = "$V1PKF0";
+  if (frame.substr(0, MOTOR_EVENT.size()) == MOTOR_EVENT) {
+    // "$V1PKF0,<code>,<event>;src=<event source>"
+    size_t src = frame.find(";src=");
+    std::string_view code = src == std::string_view::npos ? std::string_view() : frame.substr(src + 5);
+    for (size_t i = 0; i < this->count_; i++) {
+      GatePro *gate = this->gates_[i];
+      if (this->same_uart_(gate, reader) && !gate->event_source_.empty() && code == gate->event_source_) {
+        gate->process(frame);
+        return;
+      }
+    }
+    // gates without an event source take every event that matched no other gate
+    for (size_t i = 0; i < this->count_; i++) {
+      GatePro *gate = this->gates_[i];
+      if (this->same_uart_(gate, reader) && gate->event_source_.empty()) {
+        gate->process(frame);
+      }
+    }
+    return;
+  }
+
+  reader->process(frame);
+}
+
+bool GateProBus::wire_free(const GatePro *gate, uint32_t now) const {
+  for (size_t i = 0; i < this->count_; i++) {
+    const GatePro *other = this->gates_[i];
+    if (!this->same_uart_(other, gate)) {
+      continue;
+    }
+    // wait for every gate's last frame to be shifted out, then keep the gap
+    if ((int32_t) (now - other->tx_busy_until_) < (int32_t) gate->inter_frame_gap_) {
+      return false;
+    }
+    // don't talk over the controller while it is sending a frame
+    if (this->reads(other) && other->rx_framer_.size() && now - other->last_rx_ < gate->inter_frame_gap_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool GateProBus::may_send(const GatePro *gate, GateProCmd cmd) {
+  if (GateProCommandQueue::priority(cmd) <= GATEPRO_PRIORITY_MOTION) {
+    return true;
+  }
+  for (size_t i = 0; i < this->count_; i++) {
+    const GatePro *other = this->gates_[i];
+    if (other != gate && this->same_uart_(other, gate) && this->awaiting_ack_(other)) {
+      return false;
+    }
+  }
+  // the first gate in turn order that has something to send goes next
+  for (size_t k = 0; k < this->count_; k++) {
+    size_t idx = (this->tx_next_ + k) % this->count_;
+    const GatePro *other = this->gates_[idx];
+    if (other == gate) {
+      this->tx_next_ = idx + 1;
+      return true;
+    }
+    if (this->same_uart_(other, gate) && !other->tx_queue.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool GateProBus::grant_poll(const GatePro *gate, uint32_t now) {
+  if (this->polled_ && now - this->last_poll_ < this->poll_gap_) {
+    return false;
+  }
+  // the first gate in turn order whose poll is due goes next
+  for (size_t k = 0; k < this->count_; k++) {
+    size_t idx = (this->poll_next_ + k) % this->count_;
+    const GatePro *other = this->gates_[idx];
+    if (other == gate) {
+      this->poll_next_ = idx + 1;
+      this->last_poll_ = now;
+      this->polled_ = true;
+      return true;
+    }
+    if (other->poll_due_(now)) {
+      return false;
+    }
+  }
+  return this->index_(gate) < 0;
+}
+
+}  // namespace gatepro
+}  // namespace esphome
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string_view>
+#include "esphome/core/component.h"
+#include "gatepro.h"
+
+namespace esphome {
+namespace gatepro {
+
+// Coordinates several GatePro controllers on one node.
+//
+// Status polls of all gates on the hub are granted round-robin and at most
+// one per poll gap, so the RS traffic stays the same however many gates there
+// are. Gates that share a UART are also arbitrated on the wire:
+// - the first gate on the UART reads and frames it for all of them, and each
+//   frame is routed to the gate it belongs to: acknowledgements to the gate
+//   waiting for them, motor events by their src= code (see event_source)
+// - only one gate at a time may have a request waiting for its ACK, the ACK
+//   frames carry no source so they are told apart by whose turn it is
+// - turns rotate between the gates that have something to send, STOP and
+//   motion commands never wait for a turn
+class GateProBus : public Component {
+ public:
+  static const size_t MAX_GATES = 4;
+
+  // Called by GatePro::set_bus()
+  void add_gate(GatePro *gate);
+  // Minimum time between two status polls on the hub
+  void set_poll_gap(uint32_t gap_ms) { this->poll_gap_ = gap_ms; }
+
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  // True if another gate on the hub uses the same UART
+  bool shared(const GatePro *gate) const;
+  // True if the gate reads its UART, false if another gate reads it for it
+  bool reads(const GatePro *gate) const;
+  // Hands a frame read by `reader` to the gates it belongs to
+  void dispatch(GatePro *reader, std::string_view frame);
+
+  // Shared UARTs: no gate is sending and the controller is not talking
+  bool wire_free(const GatePro *gate, uint32_t now) const;
+  // Shared UARTs: whether the gate may send cmd now
+  bool may_send(const GatePro *gate, GateProCmd cmd);
+  // Whether the gate may poll its status now
+  bool grant_poll(const GatePro *gate, uint32_t now);
+
+ protected:
+  bool same_uart_(const GatePro *a, const GatePro *b) const;
+  bool awaiting_ack_(const GatePro *gate) const;
+  int index_(const GatePro *gate) const;
+
+  GatePro *gates_[MAX_GATES]{};
+  size_t count_{0};
+  size_t tx_next_{0};    // gate whose turn it is to send
+  size_t poll_next_{0};  // gate whose turn it is to poll
+  uint32_t poll_gap_{250};
+  uint32_t last_poll_{0};
+  bool polled_{false};
+};
+
+}  // namespace gatepro
+}  // namespace esphome
@@ -0,0 +1,59 @@
+#include "metrics.h"
+#include <algorithm>
+#include <iterator>
+
+namespace esphome {
+namespace gatepro {
+
+const uint32_t LatencyHistogram::BOUNDS[BUCKETS] = {
+    5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, UINT32_MAX,
+};
+
+void LatencyHistogram::add(uint32_t ms) {
+  uint8_t i = 0;
+  while (ms > BOUNDS[i]) {
+    i++;
+  }
+  this->buckets_[i]++;
+  this->count_++;
+  this->max_ = std::max(this->max_, ms);
+}
+
+void LatencyHistogram::clear() {
+  std::fill(std::begin(this->buckets_), std::end(this->buckets_), 0);
+  this->count_ = 0;
+  this->max_ = 0;
+}
+
+void GateProMetrics::clear() {
+  std::fill(std::begin(this->counters), std::end(this->counters), 0);
+  this->rx_backlog_peak = 0;
+  for (auto &histogram : this->latencies) {
+    histogram.clear();
+  }
+}
+
+const char *GateProMetrics::latency_name(GateProLatency latency) {
+  static const char *const NAMES[LATENCY_COUNT] = {"Command", "ACK", "Motion"};
+  return latency < LATENCY_COUNT ? NAMES[latency] : "?";
+}
+
+uint32_t LatencyHistogram::percentile(uint8_t pct) const {
+  if (this->count_ == 0) {
+    return 0;
+  }
+  // rank of the sample, 1-based and rounded up
+  uint64_t rank = (uint64_t(this->count_) * std::min<uint8_t>(pct, 100) + 99) / 100;
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (uint8_t i = 0; i < BUCKETS; i++) {
+    seen += this->buckets_[i];
+    if (seen >= rank) {
+      return std::min(BOUNDS[i], this->max_);
+    }
+  }
+  return this->max_;
+}
+
+}  // namespace gatepro
+}  // namespace esphome
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace gatepro {
+
+// Protocol event counters
+enum GateProCounter : uint8_t {
+  COUNTER_FRAMES_IN,
+  COUNTER_FRAMES_OUT,
+  COUNTER_PARSE_FAILURES,
+  COUNTER_QUEUE_DROPS,
+  COUNTER_RX_OVERFLOWS,
+  COUNTER_LOOP_OVERRUNS,  // loop() took longer than its budget
+  COUNTER_COUNT,
+};
+
+// Measured latencies
+enum GateProLatency : uint8_t {
+  LATENCY_COMMAND,  // queued (e.g. by control()) until written to the UART
+  LATENCY_ACK,      // first written until the matching ACK arrived, retries included
+  LATENCY_MOTION,   // OPEN/CLOSE written until the Opening/Closing motor event
+  LATENCY_COUNT,
+};
+
+// Latency histogram with fixed, roughly logarithmic millisecond buckets.
+// Adding a sample is a short scan over 12 bounds, percentiles are resolved to
+// the upper bound of their bucket.
+class LatencyHistogram {
+ public:
+  static const uint8_t BUCKETS = 12;
+  static const uint32_t BOUNDS[BUCKETS];
+
+  void add(uint32_t ms);
+  void clear();
+
+  uint32_t count() const { return this->count_; }
+  uint32_t max() const { return this->max_; }
+  uint32_t bucket(uint8_t index) const { return this->buckets_[index]; }
+  // Upper bound of the bucket holding the pct-th percentile, capped at the
+  // largest sample. 0 without samples.
+  uint32_t percentile(uint8_t pct) const;
+
+ protected:
+  uint32_t buckets_[BUCKETS]{};
+  uint32_t count_{0};
+  uint32_t max_{0};
+};
+
+// Protocol counters and latency histograms of one GatePro instance. The
+// counters only ever grow, the RX backlog is a gauge: the peak since it was
+// last reset.
+struct GateProMetrics {
+  uint32_t counters[COUNTER_COUNT]{};
+  LatencyHistogram latencies[LATENCY_COUNT];
+  uint32_t rx_backlog_peak{0};  // bytes left for the next loop()
+
+  void count(GateProCounter counter) { this->counters[counter]++; }
+  void add_latency(GateProLatency latency, uint32_t ms) { this->latencies[latency].add(ms); }
+  // Returns true for a new peak
+  bool add_rx_backlog(uint32_t bytes) {
+    if (bytes <= this->rx_backlog_peak) {
+      return false;
+    }
+    this->rx_backlog_peak = bytes;
+    return true;
+  }
+  void reset_rx_backlog() { this->rx_backlog_peak = 0; }
+  void clear();
+
+  static const char *latency_name(GateProLatency latency);
+};
+
+}  // namespace gatepro
+}  // namespace esphome
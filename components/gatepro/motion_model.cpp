@@ -0,0 +1,44 @@
+#include "motion_model.h"
+#include <algorithm>
+
+namespace esphome {
+namespace gatepro {
+
+void MotionModel::start(int8_t direction, float position, uint32_t now) {
+  this->direction_ = direction > 0 ? 1 : -1;
+  this->anchor_position_ = position;
+  this->anchor_time_ = now;
+}
+
+void MotionModel::sample(float position, uint32_t now) {
+  uint32_t dt = now - this->anchor_time_;
+  if (this->moving() && dt >= MIN_SAMPLE_INTERVAL) {
+    float travelled = (position - this->anchor_position_) * this->direction_;
+    // samples against the direction of travel say nothing about the speed
+    if (travelled > 0.0f) {
+      float measured = travelled * 1000.0f / dt;
+      float &velocity = this->velocity_[this->direction_ > 0 ? 0 : 1];
+      velocity = velocity == 0.0f ? measured : velocity + SMOOTHING * (measured - velocity);
+    }
+  }
+  this->anchor_position_ = position;
+  this->anchor_time_ = now;
+}
+
+void MotionModel::stop(float position, uint32_t now) {
+  this->direction_ = 0;
+  this->anchor_position_ = position;
+  this->anchor_time_ = now;
+}
+
+float MotionModel::estimate(uint32_t now) const {
+  if (!this->moving()) {
+    return this->anchor_position_;
+  }
+  uint32_t dt = std::min(now - this->anchor_time_, MAX_EXTRAPOLATION);
+  float step = std::min(this->velocity(this->direction_) * dt / 1000.0f, MAX_EXTRAPOLATION_STEP);
+  return std::clamp(this->anchor_position_ + step * this->direction_, 0.0f, 1.0f);
+}
+
+}  // namespace gatepro
+}  // namespace esphome
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace gatepro {
+
+// Estimates the leaf position between ACK RS samples. The gate reports its
+// position only when polled, so the model learns the travel speed of each
+// direction from consecutive samples and extrapolates from the last one.
+// Extrapolation is bounded in time and distance, so a stalled or slowed leaf
+// can never drift the estimate far from the last real reading.
+class MotionModel {
+ public:
+  static const uint32_t MIN_SAMPLE_INTERVAL = 100;  // ms, shorter deltas are too noisy for a speed
+  static constexpr uint32_t MAX_EXTRAPOLATION = 2000;   // ms past the last sample
+  static constexpr float MAX_EXTRAPOLATION_STEP = 0.10f;  // travel past the last sample
+  static constexpr float SMOOTHING = 0.3f;                // weight of a new speed measurement
+
+  // direction is +1 while opening and -1 while closing
+  void start(int8_t direction, float position, uint32_t now);
+  void sample(float position, uint32_t now);
+  void stop(float position, uint32_t now);
+
+  // Position at `now`, extrapolated from the last sample while moving
+  float estimate(uint32_t now) const;
+
+  bool moving() const { return this->direction_ != 0; }
+  int8_t direction() const { return this->direction_; }
+  // Learned travel speed of a direction in fractions of the full travel per second, 0 if unknown
+  float velocity(int8_t direction) const { return this->velocity_[direction > 0 ? 0 : 1]; }
+
+ protected:
+  int8_t direction_{0};
+  float anchor_position_{0.0f};  // last sample, or the position when motion started
+  uint32_t anchor_time_{0};
+  float velocity_[2]{0.0f, 0.0f};  // opening, closing
+};
+
+}  // namespace gatepro
+}  // namespace esphome
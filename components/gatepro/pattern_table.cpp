@@ -0,0 +1,88 @@
+#include "pattern_table.h"
+
+namespace esphome {
+namespace gatepro {
+
+static_assert(PatternTable::SLOTS == 16, "slot_() keeps the top 4 bits of the hash");
+
+void PatternTable::event(GateEndState state, bool at_rest, uint32_t now) {
+  this->learning_ = at_rest;
+  this->learn_state_ = state;
+  this->learn_since_ = now;
+  this->learn_readings_ = 0;
+}
+
+bool PatternTable::observe(uint32_t signature, uint32_t now) {
+  if (!this->learning_) {
+    return false;
+  }
+  if (now - this->learn_since_ > LEARN_WINDOW) {
+    this->learning_ = false;
+    return false;
+  }
+  // the status lags behind the event, wait until it holds still
+  if (this->learn_readings_ == 0 || signature != this->learn_signature_) {
+    this->learn_signature_ = signature;
+    this->learn_readings_ = 1;
+  } else {
+    this->learn_readings_++;
+  }
+  if (this->learn_readings_ < LEARN_READINGS) {
+    return false;
+  }
+  this->learning_ = false;
+  return this->teach(signature, this->learn_state_);
+}
+
+bool PatternTable::teach(uint32_t signature, GateEndState state) {
+  PatternEntry &entry = this->entries_[slot_(signature)];
+  bool was_confident = confident_(entry);
+  if (state == END_NONE) {
+    // a stopped gate only speaks against a signature
+    if (entry.confidence == 0 || entry.signature != signature) {
+      return false;
+    }
+    if (--entry.confidence == 0) {
+      entry = PatternEntry{};
+    }
+    return was_confident;
+  }
+  if (entry.confidence == 0) {
+    entry = {signature, (uint8_t) state, 1, {0, 0}};
+    return false;
+  }
+  if (entry.signature == signature && entry.state == state) {
+    if (entry.confidence == MAX_CONFIDENCE) {
+      return false;
+    }
+    entry.confidence++;
+    return confident_(entry);
+  }
+  // a disagreeing lesson, or another signature for the same slot
+  if (--entry.confidence == 0) {
+    entry = {signature, (uint8_t) state, 1, {0, 0}};
+  }
+  return was_confident;
+}
+
+void PatternTable::load(const PatternEntry *entries) {
+  for (size_t i = 0; i < SLOTS; i++) {
+    const PatternEntry &entry = entries[i];
+    bool valid = entry.confidence != 0 && entry.confidence <= MAX_CONFIDENCE &&
+                 (entry.state == END_OPEN || entry.state == END_CLOSED) && slot_(entry.signature) == i;
+    this->entries_[i] = valid ? PatternEntry{entry.signature, entry.state, entry.confidence, {0, 0}} : PatternEntry{};
+  }
+}
+
+size_t PatternTable::learned() const {
+  size_t count = 0;
+  for (const auto &entry : this->entries_) {
+    if (confident_(entry)) {
+      count++;
+    }
+  }
+  return count;
+}
+
+}  // namespace gatepro
+}  // namespace esphome
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "state_estimator.h"
+
+namespace esphome {
+namespace gatepro {
+
+// A learned RS status signature, kept in flash with the GateProCache. No
+// padding, the cache is compared byte for byte.
+struct PatternEntry {
+  uint32_t signature;
+  uint8_t state;       // END_OPEN or END_CLOSED
+  uint8_t confidence;  // 0 marks a free slot
+  uint8_t reserved[2];  // always zero
+};
+static_assert(sizeof(PatternEntry) == 8, "PatternEntry must not have padding");
+
+// Maps RS status signatures (see GateProStatus::signature()) to the end state
+// they stand for, for controllers whose status bytes differ from the two
+// built-in patterns.
+//
+// The table is filled from the status read right after an Opened, Closed or
+// Stopped event: once the same signature has been read LEARN_READINGS times
+// in a row within LEARN_WINDOW, the table learns from it. Agreeing lessons
+// raise an entry's confidence, disagreeing ones lower it until the entry
+// changes its state, and a signature is only looked up once it reached
+// MIN_CONFIDENCE. A stopped gate only counts against the signature it
+// reported, it never takes a slot of its own.
+//
+// The table is direct-mapped, a signature only ever lives in the slot its
+// hash points at, so a lookup is a single compare. A different signature
+// hashing to a taken slot wears the old entry down before it replaces it.
+class PatternTable {
+ public:
+  static const size_t SLOTS = 16;
+  static const uint8_t MIN_CONFIDENCE = 3;
+  static const uint8_t MAX_CONFIDENCE = 15;
+  static const uint8_t LEARN_READINGS = 2;
+  static const uint32_t LEARN_WINDOW = 10000;  // ms after the event
+
+  // The end state of a signature, END_NONE if unknown or not confident yet
+  GateEndState lookup(uint32_t signature) const {
+    const PatternEntry &entry = this->entries_[slot_(signature)];
+    return entry.signature == signature && confident_(entry) ? (GateEndState) entry.state : END_NONE;
+  }
+
+  // A motor event, `at_rest` for Opened, Closed and Stopped
+  void event(GateEndState state, bool at_rest, uint32_t now);
+  // The status after an event is still awaited, it needs a poll or two
+  bool learning(uint32_t now) const { return this->learning_ && now - this->learn_since_ <= LEARN_WINDOW; }
+  // The status after the event was a built-in pattern, nothing to learn
+  void skip() { this->learning_ = false; }
+  // A status signature. Returns true if an entry that is looked up changed,
+  // only those are worth keeping in flash.
+  bool observe(uint32_t signature, uint32_t now);
+  // Adds one lesson, END_NONE for a stopped gate. Returns like observe().
+  bool teach(uint32_t signature, GateEndState state);
+
+  const PatternEntry *entries() const { return this->entries_; }
+  // Restores the entries saved from entries(), invalid ones are dropped
+  void load(const PatternEntry *entries);
+  // Entries that are looked up
+  size_t learned() const;
+
+ protected:
+  static size_t slot_(uint32_t signature) { return (signature * 2654435761u) >> 28; }
+  static bool confident_(const PatternEntry &entry) { return entry.confidence >= MIN_CONFIDENCE; }
+
+  PatternEntry entries_[SLOTS]{};
+  // signature being watched after an event
+  bool learning_{false};
+  GateEndState learn_state_{END_NONE};
+  uint32_t learn_since_{0};
+  uint32_t learn_signature_{0};
+  uint8_t learn_readings_{0};
+};
+
+}  // namespace gatepro
+}  // namespace esphome
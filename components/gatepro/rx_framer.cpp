@@ -0,0 +1,87 @@
+#include "rx_framer.h"
+#include <algorithm>
+
+namespace esphome {
+namespace gatepro {
+
+void RxFramer::init(size_t capacity) {
+  // at least one frame must fit
+  this->capacity_ = std::max(capacity, MIN_CAPACITY);
+  this->buf_.reset(new uint8_t[this->capacity_]);
+  this->clear();
+}
+
+size_t RxFramer::write_window(uint8_t **window) {
+  if (this->count_ == this->capacity_) {
+    *window = nullptr;
+    return 0;
+  }
+  size_t tail = (this->head_ + this->count_) % this->capacity_;
+  *window = &this->buf_[tail];
+  // free space either runs up to the end of the array or up to head_
+  return tail >= this->head_ ? this->capacity_ - tail : this->head_ - tail;
+}
+
+void RxFramer::commit(size_t len) { this->count_ = std::min(this->count_ + len, this->capacity_); }
+
+bool RxFramer::peek_frame(std::string_view *frame) {
+  while (!this->frame_len_) {
+    // resume the delimiter search where the previous call stopped
+    for (size_t i = this->scanned_; i + 1 < this->count_; i++) {
+      if (this->buf_[(this->head_ + i) % this->capacity_] == '\r' &&
+          this->buf_[(this->head_ + i + 1) % this->capacity_] == '\n') {
+        this->frame_len_ = i + 2;
+        break;
+      }
+    }
+    if (!this->frame_len_) {
+      // keep a trailing '\r' unscanned, its '\n' may still be on the way
+      this->scanned_ = this->count_ ? this->count_ - 1 : 0;
+      return false;
+    }
+    if (this->discarding_) {
+      this->discarding_ = false;
+      this->pop_frame();
+    }
+  }
+
+  // rotate a frame that wraps around the end of the array to the front, so it
+  // can be viewed as one contiguous block
+  if (this->head_ + this->frame_len_ > this->capacity_) {
+    this->linearize_();
+  }
+  *frame = std::string_view(reinterpret_cast<const char *>(&this->buf_[this->head_]), this->frame_len_ - 2);
+  return true;
+}
+
+void RxFramer::pop_frame() {
+  if (!this->frame_len_) {
+    return;
+  }
+  this->head_ = (this->head_ + this->frame_len_) % this->capacity_;
+  this->count_ -= this->frame_len_;
+  this->frame_len_ = 0;
+  this->scanned_ = 0;
+}
+
+void RxFramer::clear() {
+  this->head_ = 0;
+  this->count_ = 0;
+  this->scanned_ = 0;
+  this->frame_len_ = 0;
+  this->discarding_ = false;
+}
+
+void RxFramer::resync() {
+  this->clear();
+  this->discarding_ = true;
+}
+
+void RxFramer::linearize_() {
+  uint8_t *buf = this->buf_.get();
+  std::rotate(buf, buf + this->head_, buf + this->capacity_);
+  this->head_ = 0;
+}
+
+}  // namespace gatepro
+}  // namespace esphome
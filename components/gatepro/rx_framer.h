@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace esphome {
+namespace gatepro {
+
+// Fixed-size byte ring that splits the controller's byte stream on raw "\r\n".
+// Bytes are read from the UART straight into the ring and complete frames are
+// handed out as non-owning views, so framing never allocates. The ring itself
+// is allocated once, when it is created or resized by init().
+class RxFramer {
+ public:
+  static constexpr size_t DEFAULT_CAPACITY = 512;
+  static constexpr size_t MIN_CAPACITY = 64;
+
+  explicit RxFramer(size_t capacity = DEFAULT_CAPACITY) { this->init(capacity); }
+  // Reallocates the ring and drops its contents, meant for configuration
+  void init(size_t capacity);
+
+  // Largest contiguous free region of the ring, to be filled by read_array()
+  // and then published with commit().
+  size_t write_window(uint8_t **window);
+  void commit(size_t len);
+
+  // Returns the oldest complete frame without its "\r\n" delimiter. The view
+  // stays valid until pop_frame(), commit() or clear() is called.
+  bool peek_frame(std::string_view *frame);
+  void pop_frame();
+
+  void clear();
+  // Drops everything, including the rest of the frame currently being
+  // received, so that framing resumes cleanly after the next delimiter.
+  void resync();
+  size_t size() const { return this->count_; }
+  size_t capacity() const { return this->capacity_; }
+  bool full() const { return this->count_ == this->capacity_; }
+
+ protected:
+  void linearize_();
+
+  std::unique_ptr<uint8_t[]> buf_;
+  size_t capacity_{0};
+  size_t head_{0};       // index of the oldest byte
+  size_t count_{0};      // bytes stored
+  size_t scanned_{0};    // bytes after head_ already searched for the delimiter
+  size_t frame_len_{0};  // length of the peeked frame including "\r\n", 0 if none
+  bool discarding_{false};  // dropping the tail of a frame that overflowed the ring
+};
+
+}  // namespace gatepro
+}  // namespace esphome
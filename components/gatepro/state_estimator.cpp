@@ -0,0 +1,47 @@
+#include "state_estimator.h"
+
+namespace esphome {
+namespace gatepro {
+
+void StateEstimator::event(GateEndState state, uint32_t now) {
+  this->state_ = state;
+  this->event_at_ = now;
+  this->event_seen_ = true;
+  this->confirmed_ = false;
+  // patterns read before the event describe the old position
+  this->candidate_ = END_NONE;
+  this->readings_ = 0;
+}
+
+GateEndState StateEstimator::pattern(GateEndState seen, uint32_t now) {
+  if (seen == END_NONE) {
+    this->candidate_ = END_NONE;
+    this->readings_ = 0;
+    return END_NONE;
+  }
+  if (seen == this->candidate_) {
+    if (this->readings_ < UINT8_MAX) {
+      this->readings_++;
+    }
+  } else {
+    this->candidate_ = seen;
+    this->readings_ = 1;
+  }
+
+  if (seen == this->state_) {
+    this->confirmed_ = this->event_seen_;
+    return END_NONE;
+  }
+  if (this->event_seen_ && now - this->event_at_ < this->timeout_) {
+    return END_NONE;
+  }
+  if (this->readings_ < this->confirmations_) {
+    return END_NONE;
+  }
+  this->state_ = seen;
+  this->confirmed_ = false;
+  return seen;
+}
+
+}  // namespace gatepro
+}  // namespace esphome
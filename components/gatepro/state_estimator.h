@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace gatepro {
+
+// End position of the leaf, as far as the state estimator knows it
+enum GateEndState : uint8_t {
+  END_NONE,  // moving, stopped in between, or not known yet
+  END_OPEN,
+  END_CLOSED,
+};
+
+// Fuses the two sources of the gate's end state. Motor events (Opened,
+// Closed, ...) are authoritative and taken as they arrive. RS status patterns
+// confirm them, and stand in for them when an event is lost:
+// - a pattern that agrees with the current state confirms it
+// - for `timeout` ms after an event, disagreeing patterns are ignored, the
+//   controller's status lags behind its events by a poll or two
+// - otherwise a pattern read `confirmations` times in a row is adopted
+class StateEstimator {
+ public:
+  static const uint8_t DEFAULT_CONFIRMATIONS = 2;
+  static const uint32_t DEFAULT_TIMEOUT = 2000;  // ms
+
+  void set_confirmations(uint8_t confirmations) { this->confirmations_ = confirmations ? confirmations : 1; }
+  void set_timeout(uint32_t timeout_ms) { this->timeout_ = timeout_ms; }
+  uint8_t confirmations() const { return this->confirmations_; }
+  uint32_t timeout() const { return this->timeout_; }
+
+  // A motor event, END_NONE for Opening, Closing and Stopped
+  void event(GateEndState state, uint32_t now);
+  // An RS status pattern, END_NONE if it shows no end position. Returns the
+  // end state to adopt, or END_NONE to keep the current one.
+  GateEndState pattern(GateEndState seen, uint32_t now);
+
+  GateEndState state() const { return this->state_; }
+  // The current end state was reported by an event and a pattern agrees
+  bool confirmed() const { return this->confirmed_; }
+  // Consecutive readings of the last pattern
+  uint8_t readings() const { return this->readings_; }
+
+ protected:
+  GateEndState state_{END_NONE};
+  GateEndState candidate_{END_NONE};  // pattern being counted
+  uint8_t readings_{0};
+  uint8_t confirmations_{DEFAULT_CONFIRMATIONS};
+  uint32_t timeout_{DEFAULT_TIMEOUT};
+  uint32_t event_at_{0};
+  bool event_seen_{false};
+  bool confirmed_{false};
+};
+
+}  // namespace gatepro
+}  // namespace esphome
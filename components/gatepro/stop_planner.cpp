@@ -0,0 +1,59 @@
+#include "stop_planner.h"
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace gatepro {
+
+void StopPlanner::arm(float target, int8_t direction) {
+  this->phase_ = PHASE_ARMED;
+  this->target_ = target;
+  this->direction_ = direction > 0 ? 1 : -1;
+}
+
+void StopPlanner::disarm() { this->phase_ = PHASE_IDLE; }
+
+bool StopPlanner::should_stop(float position, float velocity, uint32_t latency_ms) const {
+  if (this->phase_ != PHASE_ARMED) {
+    return false;
+  }
+  float remaining = (this->target_ - position) * this->direction_;
+  if (velocity <= 0.0f) {
+    return remaining < FALLBACK_WINDOW;
+  }
+  float lead = velocity * (latency_ms + this->coast(this->direction_)) / 1000.0f;
+  return remaining <= lead;
+}
+
+void StopPlanner::fired(float velocity) {
+  if (this->phase_ != PHASE_ARMED) {
+    return;
+  }
+  this->phase_ = PHASE_STOPPING;
+  this->fired_velocity_ = velocity;
+}
+
+void StopPlanner::motor_stopped() {
+  if (this->phase_ == PHASE_STOPPING) {
+    this->phase_ = PHASE_STOPPED;
+  }
+}
+
+bool StopPlanner::landed(float position) {
+  if (this->phase_ != PHASE_STOPPED) {
+    return false;
+  }
+  this->phase_ = PHASE_IDLE;
+  if (this->fired_velocity_ <= 0.0f) {
+    return false;
+  }
+  // positive when the leaf went past the target, so STOP has to go out earlier
+  float overshoot = (position - this->target_) * this->direction_;
+  float error_ms = overshoot / this->fired_velocity_ * 1000.0f;
+  float coast = this->coast(this->direction_) + LEARN_RATE * error_ms;
+  this->set_coast(this->direction_, std::lround(std::clamp<float>(coast, 0.0f, MAX_COAST)));
+  return true;
+}
+
+}  // namespace gatepro
+}  // namespace esphome
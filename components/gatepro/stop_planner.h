@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace gatepro {
+
+// Decides when to send STOP so a partial move lands on its target. The leaf
+// keeps moving while STOP waits for the bus and is shifted out, and again
+// while the motor coasts down afterwards. STOP is therefore sent once the
+// remaining travel is covered by velocity * (TX latency + coast time). The
+// coast time of each direction is learned from where the leaf actually came
+// to rest.
+class StopPlanner {
+ public:
+  static const uint16_t DEFAULT_COAST = 300;  // ms, until the first overshoot has been measured
+  static constexpr uint16_t MAX_COAST = 3000;    // ms
+  static constexpr float LEARN_RATE = 0.5f;   // share of a measured error applied to the coast time
+  static constexpr float FALLBACK_WINDOW = 0.05f;  // stop distance while the speed is still unknown
+
+  void arm(float target, int8_t direction);
+  void disarm();
+  bool armed() const { return this->phase_ == PHASE_ARMED; }
+  float target() const { return this->target_; }
+
+  // True once STOP must be sent to land on the target
+  bool should_stop(float position, float velocity, uint32_t latency_ms) const;
+  // STOP was sent while the leaf moved at `velocity`
+  void fired(float velocity);
+  // The controller reported the motor stopped, the next position is the landing spot
+  void motor_stopped();
+  bool landing() const { return this->phase_ == PHASE_STOPPED; }
+  // Learns from the final position, returns true if the coast time was updated
+  bool landed(float position);
+
+  uint16_t coast(int8_t direction) const { return this->coast_[direction > 0 ? 0 : 1]; }
+  void set_coast(int8_t direction, uint16_t coast_ms) { this->coast_[direction > 0 ? 0 : 1] = coast_ms; }
+
+ protected:
+  enum Phase : uint8_t {
+    PHASE_IDLE,
+    PHASE_ARMED,     // moving towards a partial target
+    PHASE_STOPPING,  // STOP sent, leaf coasting
+    PHASE_STOPPED,   // motor stopped, waiting for the final position
+  };
+
+  Phase phase_{PHASE_IDLE};
+  int8_t direction_{0};
+  float target_{0.0f};
+  float fired_velocity_{0.0f};
+  uint16_t coast_[2]{DEFAULT_COAST, DEFAULT_COAST};  // opening, closing
+};
+
+}  // namespace gatepro
+}  // namespace esphome
@@ -0,0 +1,45 @@
+#include "trace_ring.h"
+#include <algorithm>
+#include <cstring>
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace gatepro {
+
+static const char *const TRACE_EVENT_NAMES[TRACE_EVENT_COUNT] = {
+    "RX", "TX", "QUEUED", "RETRY", "GIVE UP", "MOTOR", "RESYNC",
+};
+
+void TraceRing::record(uint32_t time_us, GateProTraceEvent event, uint16_t arg, std::string_view data) {
+  TraceRecord *rec;
+  if (this->count_ == CAPACITY) {
+    // overwrite the oldest record
+    rec = &this->records_[this->head_];
+    this->head_ = (this->head_ + 1) % CAPACITY;
+  } else {
+    rec = &this->records_[(this->head_ + this->count_) % CAPACITY];
+    this->count_++;
+  }
+  rec->time_us = time_us;
+  rec->event = event;
+  rec->arg = arg;
+  rec->len = std::min(data.size(), TraceRecord::DATA_SIZE);
+  if (rec->len) {
+    memcpy(rec->data, data.data(), rec->len);  // data() may be null for an empty view
+  }
+}
+
+void TraceRing::dump(const char *tag) const {
+  ESP_LOGI(tag, "Trace, %zu records:", this->count_);
+  uint32_t prev = this->count_ ? (*this)[0].time_us : 0;
+  for (size_t i = 0; i < this->count_; i++) {
+    const TraceRecord &rec = (*this)[i];
+    const char *name = rec.event < TRACE_EVENT_COUNT ? TRACE_EVENT_NAMES[rec.event] : "?";
+    ESP_LOGI(tag, "  %10u us (+%7u) %-7s %5u '%.*s'", (unsigned) rec.time_us, (unsigned) (rec.time_us - prev), name,
+             rec.arg, (int) rec.len, rec.data);
+    prev = rec.time_us;
+  }
+}
+
+}  // namespace gatepro
+}  // namespace esphome
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace esphome {
+namespace gatepro {
+
+enum GateProTraceEvent : uint8_t {
+  TRACE_RX,        // arg: frame length
+  TRACE_TX,        // arg: commands still queued
+  TRACE_QUEUED,    // arg: queue size
+  TRACE_RETRY,     // arg: attempt
+  TRACE_GIVE_UP,   // arg: attempts
+  TRACE_MOTOR,     // arg: GateProState
+  TRACE_RESYNC,    // arg: bytes dropped
+  TRACE_EVENT_COUNT,
+};
+
+// One trace entry: what happened, when, and the first bytes of the frame.
+struct TraceRecord {
+  static constexpr size_t DATA_SIZE = 8;
+  uint32_t time_us;
+  uint8_t event;
+  uint8_t len;  // bytes used in data
+  uint16_t arg;
+  char data[DATA_SIZE];
+};
+
+// Fixed-size ring of the most recent protocol events. Recording is a copy of
+// 16 bytes, nothing is formatted until dump() is called, so tracing can stay
+// on without disturbing the timing of the bus.
+class TraceRing {
+ public:
+  static const size_t CAPACITY = 64;
+
+  void record(uint32_t time_us, GateProTraceEvent event, uint16_t arg, std::string_view data = {});
+  // Logs every record, oldest first
+  void dump(const char *tag) const;
+  void clear() { this->count_ = 0; }
+
+  size_t size() const { return this->count_; }
+  // index 0 is the oldest record
+  const TraceRecord &operator[](size_t index) const { return this->records_[(this->head_ + index) % CAPACITY]; }
+
+ protected:
+  TraceRecord records_[CAPACITY];
+  size_t head_{0};
+  size_t count_{0};
+};
+
+}  // namespace gatepro
+}  // namespace esphome
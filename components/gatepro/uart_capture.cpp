@@ -0,0 +1,93 @@
+#include "uart_capture.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace gatepro {
+
+void UartCapture::init(size_t capacity) {
+  if (capacity < HEADER_SIZE + CaptureRecord::MAX_DATA) {
+    capacity = 0;
+  }
+  this->buf_.reset(capacity ? new uint8_t[capacity] : nullptr);
+  this->capacity_ = capacity;
+  this->clear();
+}
+
+void UartCapture::clear() {
+  this->head_ = 0;
+  this->used_ = 0;
+  this->records_ = 0;
+}
+
+void UartCapture::record(uint32_t time_us, CaptureDirection direction, const uint8_t *data, size_t len) {
+  if (!this->enabled()) {
+    return;
+  }
+  while (len > 0) {
+    uint8_t chunk = std::min(len, CaptureRecord::MAX_DATA);
+    size_t needed = HEADER_SIZE + chunk;
+    while (this->capacity_ - this->used_ < needed) {
+      this->drop_oldest_();
+    }
+    uint8_t header[HEADER_SIZE] = {
+        uint8_t(time_us), uint8_t(time_us >> 8), uint8_t(time_us >> 16), uint8_t(time_us >> 24),
+        direction,        chunk,
+    };
+    size_t tail = (this->head_ + this->used_) % this->capacity_;
+    this->write_(tail, header, HEADER_SIZE);
+    this->write_((tail + HEADER_SIZE) % this->capacity_, data, chunk);
+    this->used_ += needed;
+    this->records_++;
+    data += chunk;
+    len -= chunk;
+  }
+}
+
+void UartCapture::drop_oldest_() {
+  uint8_t len;
+  this->read_((this->head_ + HEADER_SIZE - 1) % this->capacity_, &len, 1);
+  this->head_ = (this->head_ + HEADER_SIZE + len) % this->capacity_;
+  this->used_ -= HEADER_SIZE + len;
+  this->records_--;
+}
+
+void UartCapture::read_(size_t pos, uint8_t *out, size_t len) const {
+  size_t first = std::min(len, this->capacity_ - pos);
+  memcpy(out, &this->buf_[pos], first);
+  memcpy(out + first, &this->buf_[0], len - first);
+}
+
+void UartCapture::write_(size_t pos, const uint8_t *in, size_t len) {
+  size_t first = std::min(len, this->capacity_ - pos);
+  memcpy(&this->buf_[pos], in, first);
+  memcpy(&this->buf_[0], in + first, len - first);
+}
+
+size_t UartCapture::format(const CaptureRecord &rec, char *buf, size_t len) {
+  int n = snprintf(buf, len, "CAP %u %c ", (unsigned) rec.time_us, rec.direction == CAPTURE_TX ? 'T' : 'R');
+  if (n < 0 || size_t(n) + rec.len * 2 + 1 > len) {
+    return 0;
+  }
+  for (uint8_t i = 0; i < rec.len; i++) {
+    buf[n++] = HEX_DIGITS[rec.data[i] >> 4];
+    buf[n++] = HEX_DIGITS[rec.data[i] & 0x0F];
+  }
+  buf[n] = '\0';
+  return n;
+}
+
+void UartCapture::dump(const char *tag) const {
+  ESP_LOGI(tag, "Capture, %zu records, %zu of %zu bytes:", this->records_, this->used_, this->capacity_);
+  this->for_each([tag](const CaptureRecord &rec) {
+    char line[MAX_LINE];
+    if (format(rec, line, sizeof(line))) {
+      ESP_LOGI(tag, "%s", line);
+    }
+  });
+}
+
+}  // namespace gatepro
+}  // namespace esphome
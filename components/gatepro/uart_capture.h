@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esphome {
+namespace gatepro {
+
+// Upper case hex digits, for capture dumps and WP frames
+inline constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+enum CaptureDirection : uint8_t {
+  CAPTURE_RX,
+  CAPTURE_TX,
+};
+
+// One captured chunk of bus traffic. data points into a scratch buffer and is
+// only valid during the for_each() callback.
+struct CaptureRecord {
+  static constexpr size_t MAX_DATA = 64;  // longer writes are split into several records
+  uint32_t time_us;
+  CaptureDirection direction;
+  uint8_t len;
+  const uint8_t *data;
+};
+
+// Raw RX/TX bytes with microsecond timestamps, kept in a byte ring of
+// variable-size records: 4 bytes time, 1 byte direction, 1 byte length, then
+// the data. The oldest records are overwritten when the ring is full.
+//
+// The hex dump has one record per line, "CAP <time_us> <R|T> <hex bytes>",
+// which is what the host replay driver reads back.
+class UartCapture {
+ public:
+  static const size_t HEADER_SIZE = 6;
+  static const size_t MAX_LINE = 20 + CaptureRecord::MAX_DATA * 2;
+
+  // Allocates the ring once, capture stays off while the capacity is 0
+  void init(size_t capacity);
+  bool enabled() const { return this->capacity_ != 0; }
+
+  void record(uint32_t time_us, CaptureDirection direction, const uint8_t *data, size_t len);
+  void clear();
+
+  // Calls f(const CaptureRecord &) for every record, oldest first
+  template<typename F> void for_each(F f) const {
+    uint8_t data[CaptureRecord::MAX_DATA];
+    size_t pos = this->head_;
+    for (size_t done = 0; done < this->used_;) {
+      uint8_t header[HEADER_SIZE];
+      this->read_(pos, header, HEADER_SIZE);
+      CaptureRecord rec;
+      rec.time_us = uint32_t(header[0]) | (uint32_t(header[1]) << 8) | (uint32_t(header[2]) << 16) |
+                    (uint32_t(header[3]) << 24);
+      rec.direction = (CaptureDirection) header[4];
+      rec.len = header[5];
+      this->read_((pos + HEADER_SIZE) % this->capacity_, data, rec.len);
+      rec.data = data;
+      f(rec);
+      pos = (pos + HEADER_SIZE + rec.len) % this->capacity_;
+      done += HEADER_SIZE + rec.len;
+    }
+  }
+  // Formats a record as a dump line, returns its length
+  static size_t format(const CaptureRecord &rec, char *buf, size_t len);
+  // Logs every record as a dump line
+  void dump(const char *tag) const;
+
+  size_t size() const { return this->records_; }
+  size_t bytes_used() const { return this->used_; }
+  size_t capacity() const { return this->capacity_; }
+
+ protected:
+  void read_(size_t pos, uint8_t *out, size_t len) const;
+  void write_(size_t pos, const uint8_t *in, size_t len);
+  void drop_oldest_();
+
+  std::unique_ptr<uint8_t[]> buf_;
+  size_t capacity_{0};
+  size_t head_{0};     // start of the oldest record
+  size_t used_{0};     // bytes stored
+  size_t records_{0};  // records stored
+};
+
+}  // namespace gatepro
+}  // namespace esphome
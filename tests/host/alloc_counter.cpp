@@ -0,0 +1,21 @@
+#include "alloc_counter.h"
+#include <cstdlib>
+#include <new>
+
+static size_t allocation_count = 0;
+
+void *operator new(size_t size) {
+  allocation_count++;
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+namespace gatepro_test {
+size_t allocations() { return allocation_count; }
+}  // namespace gatepro_test
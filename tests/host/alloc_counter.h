@@ -0,0 +1,13 @@
+#pragma once
+
+// Counts heap allocations by replacing the global operator new. Link
+// alloc_counter.cpp into an executable to enable it there.
+
+#include <cstddef>
+
+namespace gatepro_test {
+
+// Allocations made since the program started
+size_t allocations();
+
+}  // namespace gatepro_test
@@ -0,0 +1,168 @@
+// Host microbenchmarks for the GatePro hot paths. Reports the time and the
+// number of heap allocations per frame (or per call) for framing, dispatch,
+// parsing and command building.
+//
+//   gatepro_bench          full run, timings are only meaningful in a release build
+//   gatepro_bench --quick  few iterations, checks the allocation budgets only
+//
+// The exit code is non-zero if a path allocates more than its budget, so heap
+// churn that creeps back into the loop fails the host tests.
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "alloc_counter.h"
+#include "gatepro_harness.h"
+
+using namespace esphome;
+using esphome::gatepro::testing::GateProHarness;
+using gatepro_test::allocations;
+
+////////////////////////////////////////////
+// Runner
+////////////////////////////////////////////
+static bool quick = false;
+static int over_budget = 0;
+
+// Calls fn(i) `calls` times, each call handling `frames_per_call` frames, and
+// reports per-frame figures. `budget` is the most allocations per frame the
+// path may make.
+template<typename F>
+static void bench(const char *name, size_t calls, double budget, F fn, size_t frames_per_call = 1) {
+  if (quick)
+    calls = std::min<size_t>(calls, 200);
+  fn(0);  // warm up lazily initialised state
+  size_t allocs_before = allocations();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 1; i <= calls; i++)
+    fn(i);
+  auto end = std::chrono::steady_clock::now();
+  size_t frames = calls * frames_per_call;
+  double ns = std::chrono::duration<double, std::nano>(end - start).count() / frames;
+  double allocs = double(allocations() - allocs_before) / frames;
+  bool ok = allocs <= budget;
+  if (!ok)
+    over_budget++;
+  printf("%-28s %10.1f ns/frame %8.2f allocs/frame  (budget %.2f)%s\n", name, ns, allocs, budget,
+         ok ? "" : "  OVER BUDGET");
+}
+
+// A realistic stream while the gate moves: RS answers with a changing
+// position, interleaved with the motor's own event frames
+static std::string rs_stream(size_t frames) {
+  std::string bytes;
+  char frame[64];
+  for (size_t i = 0; i < frames; i++) {
+    if (i % 10 == 9) {
+      bytes += "$V1PKF0,17,Opening;src=0001\r\n";
+      continue;
+    }
+    snprintf(frame, sizeof(frame), "ACK RS:00,80,C4,%02X,3E,16,FF,FF,FF\r\n", unsigned(0x80 | (i % 100)));
+    bytes += frame;
+  }
+  return bytes;
+}
+
+static const char *const RP_FRAME = "ACK RP,1:1,0,0,3,2,2,C,0,0,3,0,0,3,0,0,1,0";
+
+int main(int argc, char **argv) {
+  quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+  const size_t N = 100000;
+
+  GateProHarness gate;
+  gate.start();
+  gate.process(RP_FRAME);
+
+  // framing: bytes already waiting in the UART FIFO, read and split into frames
+  {
+    // the mock UART buffers with a deque, fill it up front so its allocations
+    // are not counted as the component's
+    const size_t batch = 100;
+    const size_t calls = quick ? 10 : 500;
+    gate.uart.inject(rs_stream(batch * (calls + 1)));
+    size_t framed = 0;
+    std::string_view frame;
+    bench("read_uart() framing", calls, 0, [&](size_t i) {
+      while (framed < batch * (i + 1)) {
+        gate.read_uart();
+        while (gate.rx_framer_.peek_frame(&frame)) {
+          gate.rx_framer_.pop_frame();
+          framed++;
+        }
+      }
+    }, batch);
+  }
+
+  {
+    std::string rs = "ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n";
+    // only used for VERBOSE logging, builds a std::string by design
+    bench("convert()", N, 2, [&](size_t) {
+      std::string escaped = gate.convert(reinterpret_cast<const uint8_t *>(rs.data()), rs.size());
+    });
+  }
+
+  // dispatch per frame type, with the side effects each frame has
+  struct Frame {
+    const char *name;
+    const char *frame;
+    double budget;
+  };
+  static const Frame FRAMES[] = {
+      {"process() ACK RS", "ACK RS:00,80,C4,C6,3E,16,FF,FF,FF", 0},
+      {"process() ACK RS moving", nullptr, 1},
+      {"process() $V1PKF0", "$V1PKF0,17,Opening;src=0001", 0},
+      {"process() ACK RP", RP_FRAME, 0},
+      {"process() ACK WP", "ACK WP,1", 0},
+      // text sensors take a std::string
+      {"process() ACK READ DEVINFO", "ACK READ DEVINFO:P500BU,PS21053C,V01", 1},
+      {"process() ACK LEARN STATUS", "ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0", 1},
+      {"process() unknown", "ACK SOMETHING ELSE", 0},
+  };
+  for (const auto &f : FRAMES) {
+    if (f.frame) {
+      bench(f.name, N, f.budget, [&](size_t) {
+        gate.process(f.frame);
+        gate.tx_queue.clear();
+      });
+      continue;
+    }
+    // position samples while opening, every frame publishes a new status text
+    gate.process("$V1PKF0,17,Opening;src=0001");
+    std::vector<std::string> frames;
+    char frame[64];
+    for (unsigned pct = 0; pct < 100; pct++) {
+      snprintf(frame, sizeof(frame), "ACK RS:00,80,C4,%02X,3E,16,FF,FF,FF", 0x80 | pct);
+      frames.push_back(frame);
+    }
+    bench(f.name, N, f.budget, [&](size_t i) {
+      gate.process(frames[i % frames.size()]);
+      gate.tx_queue.clear();
+    });
+  }
+
+  bench("parse_params()", N, 0, [&](size_t) { gate.parse_params(RP_FRAME); });
+
+  bench("get_command_string() RS", N, 0, [&](size_t) { gate.get_command_string(gatepro::GATEPRO_CMD_READ_STATUS); });
+  bench("get_command_string() OPEN", N, 0, [&](size_t) { gate.get_command_string(gatepro::GATEPRO_CMD_OPEN); });
+
+  // the WP is queued as plain data
+  bench("write_params()", N, 0, [&](size_t) {
+    gate.write_params();
+    gate.tx_queue.clear();
+  });
+
+  // a command from the queue to the UART, the frame is built on the stack
+  bench("queue + write_uart() STOP", N, 0, [&](size_t) {
+    gate.queue_gatepro_cmd(gatepro::GATEPRO_CMD_STOP);
+    host::advance_ms(100);
+    gate.write_uart();
+    gate.uart.clear_tx();
+  });
+
+  if (over_budget) {
+    printf("%d paths over their allocation budget\n", over_budget);
+    return 1;
+  }
+  return 0;
+}
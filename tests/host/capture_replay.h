@@ -0,0 +1,143 @@
+#pragma once
+
+// Deterministic replay of UART captures (see UartCapture) on the host. The
+// captured RX bytes are fed through read_uart()/process() at their original
+// relative timestamps while the simulated loop runs, and everything the
+// component does in response is written to a transcript. Replaying the same
+// capture always yields the same transcript, so transcripts from before and
+// after a change can be diffed.
+
+#include <cstdio>
+#include <istream>
+#include <string>
+#include <vector>
+#include "gatepro_harness.h"
+
+namespace esphome {
+namespace gatepro {
+namespace testing {
+
+struct ReplayRecord {
+  uint32_t time_us;
+  CaptureDirection direction;
+  std::string data;
+};
+
+// Parses one "CAP <time_us> <R|T> <hex>" dump line. Anything before "CAP ",
+// such as the log prefix, is skipped.
+inline bool parse_capture_line(const std::string &line, ReplayRecord *rec) {
+  size_t pos = line.find("CAP ");
+  if (pos == std::string::npos)
+    return false;
+  unsigned time_us;
+  char direction;
+  int consumed = 0;
+  if (sscanf(line.c_str() + pos, "CAP %u %c %n", &time_us, &direction, &consumed) < 2 ||
+      (direction != 'R' && direction != 'T'))
+    return false;
+  rec->time_us = time_us;
+  rec->direction = direction == 'T' ? CAPTURE_TX : CAPTURE_RX;
+  rec->data.clear();
+  for (size_t i = pos + consumed; i + 1 < line.size(); i += 2) {
+    unsigned byte;
+    if (sscanf(line.c_str() + i, "%2x", &byte) != 1)
+      break;
+    rec->data.push_back(char(byte));
+  }
+  return true;
+}
+
+inline std::vector<ReplayRecord> parse_capture(std::istream &in) {
+  std::vector<ReplayRecord> records;
+  std::string line;
+  ReplayRecord rec;
+  while (std::getline(in, line)) {
+    if (parse_capture_line(line, &rec))
+      records.push_back(rec);
+  }
+  return records;
+}
+
+inline std::vector<ReplayRecord> records_from(const UartCapture &capture) {
+  std::vector<ReplayRecord> records;
+  capture.for_each([&](const CaptureRecord &rec) {
+    records.push_back({rec.time_us, rec.direction, std::string(reinterpret_cast<const char *>(rec.data), rec.len)});
+  });
+  return records;
+}
+
+// Splits the bytes of all records in one direction into "\r\n" frames
+inline std::vector<std::string> capture_frames(const std::vector<ReplayRecord> &records, CaptureDirection direction) {
+  std::string bytes;
+  for (auto &rec : records) {
+    if (rec.direction == direction)
+      bytes += rec.data;
+  }
+  std::vector<std::string> frames;
+  size_t pos;
+  while ((pos = bytes.find("\r\n")) != std::string::npos) {
+    frames.push_back(bytes.substr(0, pos));
+    bytes.erase(0, pos + 2);
+  }
+  return frames;
+}
+
+struct ReplayResult {
+  std::vector<std::string> transcript;  // "<ms> TX <frame>" and "<ms> STATE ..." lines
+  std::vector<std::string> tx_frames;   // frames the component wrote during the replay
+};
+
+// Replays the RX side of a capture. The first record is placed at boot, the
+// source code is taken from the captured TX frames if there are any.
+inline ReplayResult replay_capture(const std::vector<ReplayRecord> &records, uint32_t loop_ms = 16,
+                                   uint32_t tail_ms = 2000) {
+  static const uint64_t START_US = 1000000;
+  ReplayResult result;
+  GateProHarness gate;
+  char line[160];
+  auto now_ms = [] { return double(host::get_time_us() - START_US) / 1000; };
+
+  for (auto &frame : capture_frames(records, CAPTURE_TX)) {
+    size_t src = frame.find(";src=");
+    if (src != std::string::npos) {
+      gate.set_source(frame.substr(src + 5));
+      break;
+    }
+  }
+  gate.add_on_state_callback([&]() {
+    snprintf(line, sizeof(line), "%10.3f STATE op=%d pos=%.3f state=%d", now_ms(), gate.current_operation,
+             gate.position, gate.gate_state_);
+    result.transcript.push_back(line);
+  });
+  auto flush_tx = [&]() {
+    for (auto &frame : gate.take_tx_frames()) {
+      snprintf(line, sizeof(line), "%10.3f TX %s", now_ms(), frame.c_str());
+      result.transcript.push_back(line);
+      result.tx_frames.push_back(frame);
+    }
+  };
+  auto run_until = [&](uint64_t end_us) {
+    while (host::get_time_us() < end_us) {
+      gate.run_until_us(std::min(end_us, host::get_time_us() + uint64_t(loop_ms) * 1000), loop_ms);
+      flush_tx();
+    }
+  };
+
+  gate.start(START_US);
+  flush_tx();
+  uint64_t at = START_US;
+  uint32_t prev = records.empty() ? 0 : records[0].time_us;
+  for (auto &rec : records) {
+    at += uint32_t(rec.time_us - prev);  // micros() wraps every ~71 minutes
+    prev = rec.time_us;
+    run_until(at);
+    if (rec.direction == CAPTURE_RX)
+      gate.feed(rec.data);
+  }
+  run_until(host::get_time_us() + uint64_t(tail_ms) * 1000);
+  return result;
+}
+
+}  // namespace testing
+}  // namespace gatepro
+}  // namespace esphome
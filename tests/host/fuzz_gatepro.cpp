@@ -0,0 +1,155 @@
+// Fuzz target for the RX pipeline: arbitrary controller bytes go through
+// read_uart(), the RX framer and process() while the simulated main loop
+// runs. Besides crashes (and sanitizer findings), every loop() is checked
+// against a CPU time and a heap allocation budget, so that no input can
+// stall the node or churn its heap.
+//
+// With clang and -DGATEPRO_FUZZ=ON this builds as a libFuzzer target:
+//
+//   gatepro_fuzz -dict=tests/host/fuzz/gatepro.dict corpus/
+//
+// Otherwise it builds with a small standalone driver that replays the files
+// given on the command line, or mutates the built-in seed frames with a fixed
+// seed when there are none. ctest runs the latter.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "alloc_counter.h"
+#include "gatepro_harness.h"
+
+using namespace esphome;
+using esphome::gatepro::testing::GateProHarness;
+
+// Bounds for a single loop() call. The CPU budget is generous for a host, it
+// catches unbounded work rather than measuring it. GATEPRO_FUZZ_LOOP_US
+// overrides it, e.g. for sanitizer builds.
+static const uint32_t DEFAULT_LOOP_BUDGET_US = 20000;
+// Room for the frames of one slice whose handlers publish text sensors, which
+// take a std::string. Queueing and writing commands never allocates.
+static const size_t LOOP_ALLOCATION_BUDGET = 10;
+// Bytes handed to the mock UART between two loop() calls
+static const size_t SLICE = 97;
+
+static uint32_t loop_budget_us() {
+  static const uint32_t budget = [] {
+    const char *env = std::getenv("GATEPRO_FUZZ_LOOP_US");
+    return env ? uint32_t(std::strtoul(env, nullptr, 10)) : DEFAULT_LOOP_BUDGET_US;
+  }();
+  return budget;
+}
+
+static void timed_loop(GateProHarness &gate) {
+  esphome::host::advance_ms(16);
+  size_t allocs_before = gatepro_test::allocations();
+  auto start = std::chrono::steady_clock::now();
+  gate.loop();
+  auto end = std::chrono::steady_clock::now();
+  size_t allocs = gatepro_test::allocations() - allocs_before;
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+  if (allocs > LOOP_ALLOCATION_BUDGET) {
+    fprintf(stderr, "loop() made %zu allocations, budget %zu\n", allocs, LOOP_ALLOCATION_BUDGET);
+    abort();
+  }
+  if (us > loop_budget_us()) {
+    fprintf(stderr, "loop() took %lldus, budget %uus\n", (long long) us, loop_budget_us());
+    abort();
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  GateProHarness gate;
+  gate.start();
+  for (size_t pos = 0; pos < size; pos += SLICE) {
+    gate.uart.inject(data + pos, std::min(SLICE, size - pos));
+    timed_loop(gate);
+    gate.uart.take_tx_frames();
+  }
+  // drain whatever is still framed, and let timeouts and retries run
+  for (int i = 0; i < 64; i++)
+    timed_loop(gate);
+  gate.update();
+  return 0;
+}
+
+#ifndef GATEPRO_LIBFUZZER
+// Frames the controller really sends, the mutations start from these
+static const char *const SEEDS[] = {
+    "ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n",
+    "ACK RS:00,A2,00,40,00,16,FF,FF,FF\r\n",
+    "ACK RS:00,A2,E3,40,00,16,FF,FF,FF\r\n",
+    "$V1PKF0,17,Opening;src=0001\r\n",
+    "$V1PKF0,17,Opened;src=0001\r\n",
+    "$V1PKF0,17,Closing;src=0001\r\n",
+    "$V1PKF0,17,Closed;src=0001\r\n",
+    "$V1PKF0,17,Stopped;src=0001\r\n",
+    "ACK RP,1:1,0,0,3,2,2,C,0,0,3,0,0,3,0,0,1,0\r\n",
+    "ACK WP,1\r\n",
+    "ACK READ DEVINFO:P500BU,PS21053C,V01\r\n",
+    "ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0\r\n",
+};
+
+// xorshift32, fixed seed so that every run tests the same inputs
+static uint32_t rng_state = 0x9E3779B9;
+static uint32_t rng(uint32_t bound) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state % bound;
+}
+
+static std::string mutate() {
+  std::string input;
+  size_t frames = 1 + rng(12);
+  for (size_t i = 0; i < frames; i++)
+    input += SEEDS[rng(sizeof(SEEDS) / sizeof(SEEDS[0]))];
+  size_t mutations = rng(8);
+  for (size_t i = 0; i < mutations && !input.empty(); i++) {
+    size_t pos = rng(input.size());
+    switch (rng(6)) {
+      case 0:  // random byte
+        input[pos] = char(rng(256));
+        break;
+      case 1:  // drop a byte
+        input.erase(pos, 1);
+        break;
+      case 2:  // duplicate a run
+        input.insert(pos, input.substr(pos, rng(32)));
+        break;
+      case 3:  // truncate, e.g. a frame cut short by a reset
+        input.resize(pos);
+        break;
+      case 4:  // stray delimiter
+        input.insert(pos, "\r\n");
+        break;
+      default:  // long run without a delimiter
+        input.insert(pos, std::string(rng(1200), char(rng(256))));
+        break;
+    }
+  }
+  return input;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    for (int i = 1; i < argc; i++) {
+      std::ifstream in(argv[i], std::ios::binary);
+      std::string input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+      LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+    }
+    printf("%d inputs passed\n", argc - 1);
+    return 0;
+  }
+  const int runs = 2000;
+  for (int i = 0; i < runs; i++) {
+    std::string input = mutate();
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+  }
+  printf("%d mutated inputs passed\n", runs);
+  return 0;
+}
+#endif
@@ -0,0 +1,181 @@
+#pragma once
+
+// Host harness for the GatePro component: a mock UART bus, a simulated clock
+// and a GatePro subclass that exposes the protocol internals to tests and
+// benchmarks.
+
+#include <algorithm>
+#include <deque>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "gatepro.h"
+#include "gatepro_bus.h"
+
+namespace esphome {
+namespace gatepro {
+namespace testing {
+
+class MockUART : public uart::UARTComponent {
+ public:
+  void write_array(const uint8_t *data, size_t len) override {
+    this->tx_.append(reinterpret_cast<const char *>(data), len);
+    this->tx_bytes_ += len;
+    this->writes_++;
+  }
+  bool peek_byte(uint8_t *data) override {
+    if (this->rx_.empty())
+      return false;
+    *data = this->rx_.front();
+    return true;
+  }
+  bool read_array(uint8_t *data, size_t len) override {
+    if (this->rx_.size() < len)
+      return false;
+    for (size_t i = 0; i < len; i++) {
+      data[i] = this->rx_.front();
+      this->rx_.pop_front();
+    }
+    return true;
+  }
+  int available() override { return (int) this->rx_.size(); }
+
+  // Queues bytes as if the controller had sent them.
+  void inject(const std::string &bytes) { this->rx_.insert(this->rx_.end(), bytes.begin(), bytes.end()); }
+  void inject(const uint8_t *data, size_t len) { this->rx_.insert(this->rx_.end(), data, data + len); }
+
+  // Returns the complete "\r\n" terminated frames written since the last call,
+  // without their delimiter.
+  std::vector<std::string> take_tx_frames() {
+    std::vector<std::string> frames;
+    size_t pos;
+    while ((pos = this->tx_.find("\r\n")) != std::string::npos) {
+      frames.push_back(this->tx_.substr(0, pos));
+      this->tx_.erase(0, pos + 2);
+    }
+    return frames;
+  }
+  const std::string &pending_tx() const { return this->tx_; }
+  void clear_tx() { this->tx_.clear(); }
+  size_t tx_bytes() const { return this->tx_bytes_; }
+  size_t writes() const { return this->writes_; }
+
+ protected:
+  std::deque<uint8_t> rx_;
+  std::string tx_;
+  size_t tx_bytes_{0};
+  size_t writes_{0};
+};
+
+class GateProHarness : public GatePro {
+ public:
+  // protocol internals
+  using GatePro::convert;
+  using GatePro::parse_params;
+  using GatePro::process;
+  using GatePro::queue_gatepro_cmd;
+  using GatePro::read_uart;
+  using GatePro::write_params;
+  using GatePro::write_uart;
+  using GatePro::rx_framer_;
+  using GatePro::in_flight_;
+  using GatePro::tx_queue;
+  using GatePro::trace_ring_;
+  // state internals
+  using GatePro::gate_state_;
+  using GatePro::operation_finished;
+  using GatePro::params;
+  using GatePro::param_txn_;
+  using GatePro::PARAM_TXN_TIMEOUT;
+
+  using GatePro::target_position_;
+  using GatePro::stop_planner_;
+  using GatePro::patterns_;
+  using GatePro::event_source_;
+
+  MockUART uart;
+  number::Number speed_number;
+  switch_::Switch permalock;
+  text_sensor::TextSensor devinfo_text;
+  text_sensor::TextSensor learn_status_text;
+  text_sensor::TextSensor status_text;
+  int publish_count{0};
+
+  // Each harness starts with empty flash unless keep_flash is set, which
+  // simulates a reboot of the previous instance.
+  explicit GateProHarness(uint32_t update_interval_ms = 500, bool keep_flash = false) {
+    if (!keep_flash)
+      host::reset_preferences();
+    this->set_uart_parent(&this->uart);
+    this->set_update_interval(update_interval_ms);
+    this->set_name("Test Gate");
+    this->set_speed_slider(&this->speed_number);
+    this->set_sw_permalock(&this->permalock);
+    this->set_txt_devinfo(&this->devinfo_text);
+    this->set_txt_learn_status(&this->learn_status_text);
+    this->set_txt_status(&this->status_text);
+    this->add_on_state_callback([this]() { this->publish_count++; });
+  }
+
+  // Resets the simulated clock and runs setup(), like App.setup() would.
+  void start(uint64_t start_us = 1000000) {
+    host::set_time_us(start_us);
+    this->setup();
+    this->next_update_ms_ = millis();
+  }
+
+  // Runs the main loop for `ms` of simulated time, calling loop() every
+  // `loop_ms` and update() every update interval.
+  void run_for(uint32_t ms, uint32_t loop_ms = 16) {
+    uint64_t end = host::get_time_us() + uint64_t(ms) * 1000;
+    while (host::get_time_us() < end) {
+      host::advance_ms(loop_ms);
+      this->tick();
+    }
+  }
+
+  // Like run_for(), but never steps past end_us, so events can be placed at
+  // exact microsecond timestamps.
+  void run_until_us(uint64_t end_us, uint32_t loop_ms = 16) {
+    while (host::get_time_us() < end_us) {
+      host::advance_us(std::min<uint64_t>(uint64_t(loop_ms) * 1000, end_us - host::get_time_us()));
+      this->tick();
+    }
+  }
+
+  // One main loop pass at the current time: loop(), and update() if it is due
+  void tick() {
+    this->loop();
+    if (int32_t(millis() - this->next_update_ms_) >= 0) {
+      this->update();
+      this->next_update_ms_ = millis() + this->get_update_interval();
+    }
+  }
+
+  void feed(const std::string &bytes) { this->uart.inject(bytes); }
+  std::vector<std::string> take_tx_frames() { return this->uart.take_tx_frames(); }
+
+ protected:
+  uint32_t next_update_ms_{0};
+};
+
+// Runs several gates in one simulated main loop, like App.loop() with one
+// GatePro per controller. on_tick is called after every pass, e.g. to play the
+// controllers' side of a shared bus.
+template<typename F>
+void run_gates(std::initializer_list<GateProHarness *> gates, uint32_t ms, F on_tick, uint32_t loop_ms = 16) {
+  uint64_t end = host::get_time_us() + uint64_t(ms) * 1000;
+  while (host::get_time_us() < end) {
+    host::advance_ms(loop_ms);
+    for (GateProHarness *gate : gates)
+      gate->tick();
+    on_tick();
+  }
+}
+inline void run_gates(std::initializer_list<GateProHarness *> gates, uint32_t ms) {
+  run_gates(gates, ms, [] {});
+}
+
+}  // namespace testing
+}  // namespace gatepro
+}  // namespace esphome
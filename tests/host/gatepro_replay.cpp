@@ -0,0 +1,47 @@
+// Replays a UART capture dump through the GatePro component and prints the
+// resulting transcript. The dump can be pasted straight from the device log:
+//
+//   gatepro_replay capture.log > before.txt
+//   (change the parser or state machine, rebuild)
+//   gatepro_replay capture.log > after.txt && diff before.txt after.txt
+
+#include <fstream>
+#include <iostream>
+#include "capture_replay.h"
+
+using namespace esphome::gatepro;
+using namespace esphome::gatepro::testing;
+
+int main(int argc, char **argv) {
+  std::vector<ReplayRecord> records;
+  if (argc > 1) {
+    std::ifstream in(argv[1]);
+    if (!in) {
+      fprintf(stderr, "Cannot open %s\n", argv[1]);
+      return 2;
+    }
+    records = parse_capture(in);
+  } else {
+    records = parse_capture(std::cin);
+  }
+  if (records.empty()) {
+    fprintf(stderr, "No CAP records found\n");
+    return 2;
+  }
+
+  ReplayResult result = replay_capture(records);
+  for (auto &line : result.transcript)
+    printf("%s\n", line.c_str());
+
+  // how far the replayed TX deviates from what the device sent
+  auto captured = capture_frames(records, CAPTURE_TX);
+  size_t common = std::min(captured.size(), result.tx_frames.size());
+  size_t differing = 0;
+  for (size_t i = 0; i < common; i++) {
+    if (captured[i] != result.tx_frames[i])
+      differing++;
+  }
+  fprintf(stderr, "%zu records, TX frames: %zu captured, %zu replayed, %zu of the first %zu differ\n",
+          records.size(), captured.size(), result.tx_frames.size(), differing, common);
+  return 0;
+}
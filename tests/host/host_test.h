@@ -0,0 +1,60 @@
+#pragma once
+
+// Minimal self-registering test runner for the host test binaries.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace gatepro_test {
+
+struct TestCase {
+  const char *name;
+  void (*fn)();
+};
+
+inline std::vector<TestCase> &registry() {
+  static std::vector<TestCase> tests;
+  return tests;
+}
+
+inline int &failures() {
+  static int count = 0;
+  return count;
+}
+
+struct Registrar {
+  Registrar(const char *name, void (*fn)()) { registry().push_back({name, fn}); }
+};
+
+inline int run_all() {
+  int failed_tests = 0;
+  for (auto &test : registry()) {
+    int before = failures();
+    test.fn();
+    bool ok = failures() == before;
+    if (!ok)
+      failed_tests++;
+    printf("[%s] %s\n", ok ? "  OK  " : "FAILED", test.name);
+  }
+  printf("%zu tests, %d failed\n", registry().size(), failed_tests);
+  return failed_tests ? 1 : 0;
+}
+
+}  // namespace gatepro_test
+
+#define GP_TEST(name) \
+  static void name(); \
+  static gatepro_test::Registrar name##_registrar(#name, name); \
+  static void name()
+
+#define GP_CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      printf("  %s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      gatepro_test::failures()++; \
+    } \
+  } while (0)
+
+#define GP_CHECK_EQ(a, b) GP_CHECK((a) == (b))
+#define GP_CHECK_NEAR(a, b, eps) GP_CHECK(std::fabs((a) - (b)) <= (eps))
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "esphome/core/entity_base.h"
+
+namespace esphome {
+namespace button {
+
+class Button : public EntityBase {
+ public:
+  void press() {
+    for (auto &cb : this->callbacks_)
+      cb();
+  }
+  void add_on_press_callback(std::function<void()> &&f) { this->callbacks_.push_back(std::move(f)); }
+
+ protected:
+  std::vector<std::function<void()>> callbacks_;
+};
+
+}  // namespace button
+}  // namespace esphome
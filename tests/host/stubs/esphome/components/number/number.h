@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "esphome/core/entity_base.h"
+
+namespace esphome {
+namespace number {
+
+class Number : public EntityBase {
+ public:
+  float state{0.0f};
+  bool has_state() const { return this->has_state_; }
+
+  void publish_state(float state) {
+    this->state = state;
+    this->has_state_ = true;
+    for (auto &cb : this->callbacks_)
+      cb(state);
+  }
+  void add_on_state_callback(std::function<void(float)> &&f) { this->callbacks_.push_back(std::move(f)); }
+
+ protected:
+  bool has_state_{false};
+  std::vector<std::function<void(float)>> callbacks_;
+};
+
+}  // namespace number
+}  // namespace esphome
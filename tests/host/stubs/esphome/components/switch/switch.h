@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "esphome/core/entity_base.h"
+
+namespace esphome {
+namespace switch_ {
+
+class Switch : public EntityBase {
+ public:
+  bool state{false};
+
+  void turn_on() { this->write_state(true); }
+  void turn_off() { this->write_state(false); }
+  void publish_state(bool state) {
+    this->state = state;
+    for (auto &cb : this->callbacks_)
+      cb(state);
+  }
+  void add_on_state_callback(std::function<void(bool)> &&f) { this->callbacks_.push_back(std::move(f)); }
+
+ protected:
+  // Template switches in optimistic mode echo the requested state.
+  virtual void write_state(bool state) { this->publish_state(state); }
+
+  std::vector<std::function<void(bool)>> callbacks_;
+};
+
+}  // namespace switch_
+}  // namespace esphome
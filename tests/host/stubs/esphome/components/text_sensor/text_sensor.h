@@ -0,0 +1,30 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "esphome/core/entity_base.h"
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor : public EntityBase {
+ public:
+  std::string state;
+  bool has_state() const { return this->has_state_; }
+
+  void publish_state(const std::string &state) {
+    this->state = state;
+    this->has_state_ = true;
+    for (auto &cb : this->callbacks_)
+      cb(state);
+  }
+  void add_on_state_callback(std::function<void(std::string)> &&f) { this->callbacks_.push_back(std::move(f)); }
+
+ protected:
+  bool has_state_{false};
+  std::vector<std::function<void(std::string)>> callbacks_;
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
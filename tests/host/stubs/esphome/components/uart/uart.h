@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace uart {
+
+// Host stand-in for the UART bus. Tests use a concrete mock that records
+// written bytes and serves queued RX bytes.
+class UARTComponent {
+ public:
+  virtual ~UARTComponent() = default;
+
+  virtual void write_array(const uint8_t *data, size_t len) = 0;
+  virtual bool peek_byte(uint8_t *data) = 0;
+  virtual bool read_array(uint8_t *data, size_t len) = 0;
+  virtual int available() = 0;
+  virtual void flush() {}
+
+  void write_byte(uint8_t data) { this->write_array(&data, 1); }
+  bool read_byte(uint8_t *data) { return this->read_array(data, 1); }
+
+  void set_baud_rate(uint32_t baud_rate) { this->baud_rate_ = baud_rate; }
+  uint32_t get_baud_rate() const { return this->baud_rate_; }
+
+ protected:
+  uint32_t baud_rate_{9600};
+};
+
+class UARTDevice {
+ public:
+  UARTDevice() = default;
+  UARTDevice(UARTComponent *parent) : parent_(parent) {}
+
+  void set_uart_parent(UARTComponent *parent) { this->parent_ = parent; }
+
+  void write_byte(uint8_t data) { this->parent_->write_byte(data); }
+  void write_array(const uint8_t *data, size_t len) { this->parent_->write_array(data, len); }
+  void write_array(const std::vector<uint8_t> &data) { this->parent_->write_array(data.data(), data.size()); }
+  void write_str(const char *str) { this->parent_->write_array(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+
+  bool read_byte(uint8_t *data) { return this->parent_->read_byte(data); }
+  bool peek_byte(uint8_t *data) { return this->parent_->peek_byte(data); }
+  bool read_array(uint8_t *data, size_t len) { return this->parent_->read_array(data, len); }
+  int available() { return this->parent_->available(); }
+  void flush() { this->parent_->flush(); }
+
+ protected:
+  UARTComponent *parent_{nullptr};
+};
+
+}  // namespace uart
+}  // namespace esphome
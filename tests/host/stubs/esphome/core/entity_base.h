@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+
+class EntityBase {
+ public:
+  const std::string &get_name() const { return this->name_; }
+  void set_name(const std::string &name) { this->name_ = name; }
+
+  // FNV-1 hash of the name, like the real object id hash.
+  uint32_t get_object_id_hash() const {
+    uint32_t hash = 2166136261UL;
+    for (char c : this->name_) {
+      hash *= 16777619UL;
+      hash ^= (uint8_t) c;
+    }
+    return hash;
+  }
+
+ protected:
+  std::string name_;
+};
+
+}  // namespace esphome
@@ -0,0 +1,23 @@
+#pragma once
+
+// Host stand-in for esphome/core/hal.h backed by a simulated clock.
+
+#include <cstdint>
+
+namespace esphome {
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+namespace host {
+
+// Simulated clock controls. Time only moves when a test advances it.
+void set_time_us(uint64_t us);
+uint64_t get_time_us();
+void advance_us(uint64_t us);
+inline void advance_ms(uint32_t ms) { advance_us(uint64_t(ms) * 1000); }
+
+}  // namespace host
+}  // namespace esphome
@@ -0,0 +1,69 @@
+#pragma once
+
+// Host stand-in for esphome/core/log.h. Mirrors the level gating of the real
+// header so that statements above ESPHOME_LOG_LEVEL compile to nothing.
+
+#include <cstdarg>
+#include <cstdio>
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_DEBUG
+#endif
+
+namespace esphome {
+
+// Formats the message and forwards it to the host log sink. Output is only
+// printed when GATEPRO_HOST_LOG is set in the environment, but the format
+// string is always evaluated so that format/argument mismatches are caught.
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+}  // namespace esphome
+
+#define esph_log_(level, tag, format, ...) \
+  ::esphome::esp_log_printf_(level, tag, __LINE__, format, ##__VA_ARGS__)
+
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_ERROR
+#define ESP_LOGE(tag, ...) esph_log_(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#else
+#define ESP_LOGE(tag, ...)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_WARN
+#define ESP_LOGW(tag, ...) esph_log_(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#else
+#define ESP_LOGW(tag, ...)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_INFO
+#define ESP_LOGI(tag, ...) esph_log_(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#else
+#define ESP_LOGI(tag, ...)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_CONFIG
+#define ESP_LOGCONFIG(tag, ...) esph_log_(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#else
+#define ESP_LOGCONFIG(tag, ...)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_DEBUG
+#define ESP_LOGD(tag, ...) esph_log_(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#else
+#define ESP_LOGD(tag, ...)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERBOSE
+#define ESP_LOGV(tag, ...) esph_log_(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#else
+#define ESP_LOGV(tag, ...)
+#endif
+#if ESPHOME_LOG_LEVEL >= ESPHOME_LOG_LEVEL_VERY_VERBOSE
+#define ESP_LOGVV(tag, ...) esph_log_(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+#else
+#define ESP_LOGVV(tag, ...)
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+
+// In-memory stand-in for ESPHome's flash/RTC preference store.
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  explicit ESPPreferenceObject(uint32_t key) : key_(key), valid_(true) {}
+
+  template<typename T> bool save(const T *src) { return this->save_(src, sizeof(T)); }
+  template<typename T> bool load(T *dest) { return this->load_(dest, sizeof(T)); }
+
+ protected:
+  bool save_(const void *data, size_t len);
+  bool load_(void *data, size_t len);
+
+  uint32_t key_{0};
+  bool valid_{false};
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool /*in_flash*/) {
+    return ESPPreferenceObject(type);
+  }
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type) { return ESPPreferenceObject(type); }
+};
+
+extern ESPPreferences *global_preferences;
+
+namespace host {
+// Forgets every stored preference, like a freshly erased flash.
+void reset_preferences();
+// Number of save() calls since the last reset.
+uint32_t preference_writes();
+}  // namespace host
+
+}  // namespace esphome
@@ -0,0 +1,120 @@
+// Implementations backing the host stand-ins in this directory.
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+#include "esphome/components/cover/cover.h"
+
+namespace esphome {
+
+////////////////////////////////////////////
+// Simulated clock
+////////////////////////////////////////////
+static uint64_t host_time_us = 0;
+
+uint32_t millis() { return uint32_t(host_time_us / 1000); }
+uint32_t micros() { return uint32_t(host_time_us); }
+void delay(uint32_t ms) { host_time_us += uint64_t(ms) * 1000; }
+void delayMicroseconds(uint32_t us) { host_time_us += us; }
+
+namespace host {
+void set_time_us(uint64_t us) { host_time_us = us; }
+uint64_t get_time_us() { return host_time_us; }
+void advance_us(uint64_t us) { host_time_us += us; }
+}  // namespace host
+
+////////////////////////////////////////////
+// Logging
+////////////////////////////////////////////
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...) {
+  static const char LEVEL_CHARS[] = "-EWICDVV";
+  static const bool enabled = std::getenv("GATEPRO_HOST_LOG") != nullptr;
+  char buf[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (enabled) {
+    fprintf(stderr, "[%10.3f][%c][%s:%d]: %s\n", host_time_us / 1e6, LEVEL_CHARS[level & 7], tag, line, buf);
+  }
+}
+
+////////////////////////////////////////////
+// Preferences
+////////////////////////////////////////////
+static std::map<uint32_t, std::vector<uint8_t>> host_preferences;
+static uint32_t host_preference_writes = 0;
+
+static ESPPreferences host_preference_store;
+ESPPreferences *global_preferences = &host_preference_store;
+
+bool ESPPreferenceObject::save_(const void *data, size_t len) {
+  if (!this->valid_)
+    return false;
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  host_preferences[this->key_].assign(bytes, bytes + len);
+  host_preference_writes++;
+  return true;
+}
+
+bool ESPPreferenceObject::load_(void *data, size_t len) {
+  auto it = host_preferences.find(this->key_);
+  if (!this->valid_ || it == host_preferences.end() || it->second.size() != len)
+    return false;
+  memcpy(data, it->second.data(), len);
+  return true;
+}
+
+namespace host {
+void reset_preferences() {
+  host_preferences.clear();
+  host_preference_writes = 0;
+}
+uint32_t preference_writes() { return host_preference_writes; }
+}  // namespace host
+
+////////////////////////////////////////////
+// Cover
+////////////////////////////////////////////
+namespace cover {
+
+const float COVER_OPEN = 1.0f;
+const float COVER_CLOSED = 0.0f;
+
+CoverCall &CoverCall::set_command_open() {
+  this->position_ = COVER_OPEN;
+  return *this;
+}
+CoverCall &CoverCall::set_command_close() {
+  this->position_ = COVER_CLOSED;
+  return *this;
+}
+CoverCall &CoverCall::set_command_stop() {
+  this->stop_ = true;
+  return *this;
+}
+CoverCall &CoverCall::set_command_toggle() {
+  this->toggle_ = true;
+  return *this;
+}
+CoverCall &CoverCall::set_position(float position) {
+  this->position_ = position;
+  return *this;
+}
+CoverCall &CoverCall::set_stop(bool stop) {
+  this->stop_ = stop;
+  return *this;
+}
+void CoverCall::perform() { this->parent_->control(*this); }
+
+void Cover::publish_state(bool /*save*/) {
+  for (auto &cb : this->state_callbacks_)
+    cb();
+}
+
+}  // namespace cover
+}  // namespace esphome
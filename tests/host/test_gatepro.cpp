@@ -0,0 +1,1393 @@
+// Host tests for the GatePro protocol handling. Bytes are fed through the
+// mock UART and the component is driven by the simulated main loop.
+
+#include <sstream>
+#include "capture_replay.h"
+#include "gatepro_harness.h"
+#include "host_test.h"
+
+using namespace esphome;
+using esphome::gatepro::testing::GateProHarness;
+
+static const char *const SOURCE = "P00287D7";
+
+static size_t count(const std::vector<std::string> &frames, const std::string &frame) {
+  size_t n = 0;
+  for (auto &f : frames) {
+    if (f == frame)
+      n++;
+  }
+  return n;
+}
+
+static bool contains(const std::vector<std::string> &frames, const std::string &frame) {
+  for (auto &f : frames) {
+    if (f == frame)
+      return true;
+  }
+  return false;
+}
+
+GP_TEST(setup_sends_boot_commands) {
+  GateProHarness gate;
+  gate.set_source(SOURCE);
+  gate.start();
+  gate.run_for(5000);
+
+  auto frames = gate.take_tx_frames();
+  GP_CHECK(contains(frames, "RS;src=P00287D7"));
+  GP_CHECK(contains(frames, "RP,1:;src=P00287D7"));
+  GP_CHECK(contains(frames, "READ DEVINFO;src=P00287D7"));
+  GP_CHECK(contains(frames, "READ LEARN STATUS;src=P00287D7"));
+}
+
+GP_TEST(read_params_publishes_entities) {
+  GateProHarness gate;
+  gate.start();
+  gate.feed("ACK RP,1:1,0,0,3,2,2,0,0,0,3,0,0,3,0,0,1,0\r\n");
+  gate.run_for(100);
+
+  GP_CHECK(gate.params.complete());
+  GP_CHECK_EQ(gate.speed_number.state, 3.0f);
+  GP_CHECK(gate.permalock.state);
+}
+
+GP_TEST(motor_events_drive_operation) {
+  GateProHarness gate;
+  gate.start();
+  gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.current_operation, cover::COVER_OPERATION_OPENING);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_OPENING);
+
+  gate.feed("$V1PKF0,17,Opened;src=0001\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.current_operation, cover::COVER_OPERATION_IDLE);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_OPEN);
+}
+
+GP_TEST(status_updates_position_while_moving) {
+  GateProHarness gate;
+  gate.start();
+  gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+  gate.feed("ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n");
+  gate.run_for(100);
+  // 0xC6 = 198, minus the 128 flag offset
+  GP_CHECK_NEAR(gate.position, 0.70f, 0.001f);
+}
+
+GP_TEST(info_frames_publish_text_sensors) {
+  GateProHarness gate;
+  gate.start();
+  gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  gate.feed("ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.devinfo_text.state, "P500BU,PS21053C,V01");
+  GP_CHECK_EQ(gate.learn_status_text.state, "SYSTEM LEARN COMPLETE,0");
+}
+
+GP_TEST(framer_reassembles_split_and_wrapped_frames) {
+  gatepro::RxFramer framer;
+  std::vector<std::string> frames;
+  auto push = [&](const std::string &bytes) {
+    size_t done = 0;
+    while (done < bytes.size()) {
+      uint8_t *window;
+      size_t room = framer.write_window(&window);
+      size_t n = std::min(room, bytes.size() - done);
+      memcpy(window, bytes.data() + done, n);
+      framer.commit(n);
+      done += n;
+      std::string_view frame;
+      while (framer.peek_frame(&frame)) {
+        frames.emplace_back(frame);
+        framer.pop_frame();
+      }
+    }
+  };
+
+  // split inside the delimiter
+  push("ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r");
+  GP_CHECK(frames.empty());
+  push("\nACK WP,1\r\n");
+  GP_CHECK_EQ(frames.size(), 2u);
+  GP_CHECK_EQ(frames[0], "ACK RS:00,80,C4,C6,3E,16,FF,FF,FF");
+  GP_CHECK_EQ(frames[1], "ACK WP,1");
+
+  // enough traffic to wrap the ring several times
+  frames.clear();
+  for (int i = 0; i < 100; i++)
+    push("$V1PKF0,17,Closing;src=0001\r\n");
+  GP_CHECK_EQ(frames.size(), 100u);
+  bool all_equal = true;
+  for (auto &f : frames)
+    all_equal &= f == "$V1PKF0,17,Closing;src=0001";
+  GP_CHECK(all_equal);
+}
+
+GP_TEST(rx_overflow_drops_garbage_and_recovers) {
+  GateProHarness gate;
+  gate.start();
+  gate.feed(std::string(2000, 'x'));
+  gate.run_for(100);
+  // the tail of the oversized frame is discarded up to its delimiter
+  gate.feed("ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0\r\n");
+  gate.run_for(100);
+  GP_CHECK(!gate.learn_status_text.has_state());
+  gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.devinfo_text.state, "P500BU,PS21053C,V01");
+}
+
+GP_TEST(commands_do_not_wait_for_update_interval) {
+  GateProHarness gate(60000);
+  gate.start();
+  gate.make_call().set_command_stop().perform();
+  gate.run_for(1000);
+
+  auto frames = gate.take_tx_frames();
+  GP_CHECK(contains(frames, "STOP;src=P00287D7"));
+}
+
+GP_TEST(tx_keeps_inter_frame_gap) {
+  GateProHarness gate(60000);
+  gate.set_inter_frame_gap(100);
+  gate.start();
+  // RS;src=P00287D7\r\n is 17 bytes, ~18ms at 9600 baud
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.take_tx_frames().size(), 1u);
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.take_tx_frames().size(), 1u);
+}
+
+GP_TEST(unanswered_request_is_retried_with_backoff) {
+  GateProHarness gate(60000);
+  gate.start();
+  gate.tx_queue.clear();
+  gate.queue_gatepro_cmd(gatepro::GATEPRO_CMD_DEVINFO);
+
+  // sent, then retried after 1s and 2s more, then given up after 4s
+  gate.run_for(900);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "READ DEVINFO;src=P00287D7"), 1u);
+  gate.run_for(1000);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "READ DEVINFO;src=P00287D7"), 1u);
+  gate.run_for(2000);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "READ DEVINFO;src=P00287D7"), 1u);
+  gate.run_for(6000);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "READ DEVINFO;src=P00287D7"), 0u);
+  GP_CHECK(!gate.in_flight_[gatepro::GATEPRO_ACK_DEVINFO].active);
+}
+
+GP_TEST(ack_latency_includes_retries) {
+  GateProHarness gate(60000);
+  gate.start();
+  gate.tx_queue.clear();
+  gate.queue_gatepro_cmd(gatepro::GATEPRO_CMD_DEVINFO);
+
+  // the first attempt is lost, the retry after 1s is answered
+  gate.run_for(1200);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "READ DEVINFO;src=P00287D7"), 2u);
+  gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  gate.run_for(50);
+  const auto &latency = gate.get_latency(gatepro::LATENCY_ACK);
+  GP_CHECK_EQ(latency.count(), 1u);
+  GP_CHECK(latency.max() >= 1000);
+}
+
+GP_TEST(one_outstanding_request_per_ack_type) {
+  GateProHarness gate(60000);
+  gate.start();
+  gate.tx_queue.clear();
+  gate.queue_gatepro_cmd(gatepro::GATEPRO_CMD_DEVINFO);
+  gate.run_for(100);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "READ DEVINFO;src=P00287D7"), 1u);
+
+  // the second DEVINFO waits for the first ACK, STOP does not
+  gate.queue_gatepro_cmd(gatepro::GATEPRO_CMD_DEVINFO);
+  gate.queue_gatepro_cmd(gatepro::GATEPRO_CMD_STOP);
+  gate.run_for(300);
+  auto frames = gate.take_tx_frames();
+  GP_CHECK_EQ(count(frames, "READ DEVINFO;src=P00287D7"), 0u);
+  GP_CHECK(contains(frames, "STOP;src=P00287D7"));
+
+  gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  gate.run_for(300);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "READ DEVINFO;src=P00287D7"), 1u);
+  gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  gate.run_for(100);
+  GP_CHECK(!gate.in_flight_[gatepro::GATEPRO_ACK_DEVINFO].active);
+}
+
+GP_TEST(queue_orders_by_priority_and_coalesces) {
+  using namespace gatepro;
+  GateProCommandQueue queue;
+  queue.push({GATEPRO_CMD_READ_STATUS});
+  queue.push({GATEPRO_CMD_READ_PARAMS});
+  queue.push({GATEPRO_CMD_READ_STATUS});
+  queue.push({GATEPRO_CMD_OPEN});
+  queue.push({GATEPRO_CMD_CLOSE});
+  GP_CHECK_EQ(queue.size(), 3u);
+  GP_CHECK_EQ(queue[0].cmd, GATEPRO_CMD_CLOSE);
+  GP_CHECK_EQ(queue[1].cmd, GATEPRO_CMD_READ_STATUS);
+  GP_CHECK_EQ(queue[2].cmd, GATEPRO_CMD_READ_PARAMS);
+
+  // STOP cancels the pending motion and goes first
+  queue.push({GATEPRO_CMD_STOP});
+  GP_CHECK_EQ(queue.size(), 3u);
+  GP_CHECK_EQ(queue[0].cmd, GATEPRO_CMD_STOP);
+  GP_CHECK_EQ(queue[1].cmd, GATEPRO_CMD_READ_STATUS);
+
+  // a newer WP replaces the values of the queued one
+  GateProParams first, second;
+  first.set(0, 1);
+  second.set(0, 2);
+  queue.push({GATEPRO_CMD_WRITE_PARAMS, 0, first});
+  queue.push({GATEPRO_CMD_WRITE_PARAMS, 0, second});
+  GP_CHECK_EQ(queue.size(), 4u);
+  GP_CHECK_EQ(queue[1].params[0], 2);
+}
+
+GP_TEST(full_queue_never_drops_motion) {
+  using namespace gatepro;
+  GateProCommandQueue queue;
+  const GateProCmd fillers[] = {GATEPRO_CMD_READ_STATUS, GATEPRO_CMD_READ_PARAMS, GATEPRO_CMD_DEVINFO,
+                                GATEPRO_CMD_READ_LEARN_STATUS, GATEPRO_CMD_READ_FUNCTION, GATEPRO_CMD_LEARN,
+                                GATEPRO_CMD_REMOTE_LEARN, GATEPRO_CMD_CLEAR_REMOTE_LEARN, GATEPRO_CMD_RESTORE,
+                                GATEPRO_CMD_WRITE_PARAMS};
+  for (auto cmd : fillers)
+    queue.push({cmd});
+  GP_CHECK_EQ(queue.size(), GateProCommandQueue::DEFAULT_CAPACITY);
+
+  GP_CHECK(queue.push({GATEPRO_CMD_OPEN}));
+  GP_CHECK(queue.push({GATEPRO_CMD_STOP}));
+  GP_CHECK_EQ(queue[0].cmd, GATEPRO_CMD_STOP);
+  GP_CHECK(queue[1].cmd != GATEPRO_CMD_OPEN);
+  GP_CHECK(queue.push({GATEPRO_CMD_CLOSE}));
+  GP_CHECK_EQ(queue[1].cmd, GATEPRO_CMD_CLOSE);
+  // reads evicted to make room are not re-admitted over other reads
+  GP_CHECK(!queue.push({GATEPRO_CMD_READ_FUNCTION}));
+  GP_CHECK_EQ(queue.size(), GateProCommandQueue::DEFAULT_CAPACITY);
+}
+
+GP_TEST(command_frames_are_prebuilt_per_source) {
+  GateProHarness gate(60000);
+  gate.set_source("P0031A2C");
+  gate.start();
+  GP_CHECK_EQ(gate.get_command_string(gatepro::GATEPRO_CMD_OPEN), "FULL OPEN;src=P0031A2C");
+  GP_CHECK_EQ(gate.get_command_string(gatepro::GATEPRO_CMD_READ_FUNCTION), "READ FUNCTION;src=P0031A2C");
+  GP_CHECK(gate.get_command_string(gatepro::GATEPRO_CMD_WRITE_PARAMS).empty());
+
+  // one write per frame, delimiter included
+  gate.feed("ACK RS:00,A2,00,40,00,16,FF,FF,FF\r\n");
+  gate.run_for(5000);
+  gate.uart.take_tx_frames();
+  size_t writes = gate.uart.writes();
+  gate.make_call().set_command_stop().perform();
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.uart.writes(), writes + 1);
+  GP_CHECK_EQ(gate.uart.pending_tx(), "STOP;src=P0031A2C\r\n");
+}
+
+GP_TEST(stop_preempts_boot_commands) {
+  GateProHarness gate(60000);
+  gate.start();
+  gate.make_call().set_command_stop().perform();
+  gate.run_for(40);
+  auto frames = gate.take_tx_frames();
+  GP_CHECK(!frames.empty() && frames[0] == "STOP;src=P00287D7");
+}
+
+GP_TEST(polling_follows_motor_events) {
+  GateProHarness gate(60000);
+  gate.set_moving_poll_interval(500);
+  gate.set_idle_poll_interval(30000);
+  gate.start();
+  gate.run_for(100);
+  gate.feed("ACK RS:00,A2,00,40,00,16,FF,FF,FF\r\n");
+  gate.run_for(1900);
+  gate.take_tx_frames();
+
+  // idle: no polls until the idle interval is up
+  gate.run_for(5000);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "RS;src=P00287D7"), 0u);
+
+  // a motion started by a remote switches to fast polling right away
+  gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "RS;src=P00287D7"), 1u);
+  for (int i = 0; i < 4; i++) {
+    gate.run_for(400);
+    gate.feed("ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n");
+    gate.run_for(100);
+  }
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "RS;src=P00287D7"), 4u);
+
+  // and back to idle once the gate has stopped moving
+  gate.feed("$V1PKF0,17,Opened;src=0001\r\n");
+  gate.run_for(200);
+  gate.feed("ACK RS:00,A2,E3,40,00,16,FF,FF,FF\r\n");
+  gate.take_tx_frames();
+  gate.run_for(5000);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "RS;src=P00287D7"), 0u);
+}
+
+GP_TEST(unknown_state_polls_fast_until_first_status) {
+  GateProHarness gate(60000);
+  gate.set_moving_poll_interval(500);
+  gate.set_idle_poll_interval(30000);
+  gate.start();
+  gate.run_for(100);
+  gate.take_tx_frames();
+
+  // the boot poll went unanswered, the state is still unknown
+  gate.run_for(5000);
+  GP_CHECK(count(gate.take_tx_frames(), "RS;src=P00287D7") >= 5u);
+
+  gate.feed("ACK RS:00,A2,00,40,00,16,FF,FF,FF\r\n");
+  // polls already queued still run out their retries
+  gate.run_for(10000);
+  gate.take_tx_frames();
+  gate.run_for(10000);
+  GP_CHECK_EQ(count(gate.take_tx_frames(), "RS;src=P00287D7"), 0u);
+}
+
+GP_TEST(motor_event_words_are_matched_exactly) {
+  GateProHarness gate;
+  gate.start();
+  gate.feed("$V1PKF0,17,AutoClosing;src=0001\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_CLOSING);
+
+  // truncated and unknown events are ignored
+  gate.feed("$V1PKF0\r\n$V1PKF0,17\r\n$V1PKF0,17,Closedx;src=0001\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_CLOSING);
+}
+
+GP_TEST(status_decoder_reads_all_bytes) {
+  gatepro::GateProStatus status;
+  GP_CHECK(gatepro::GateProStatus::decode("ACK RS:00,80,C4,C6,3E,16,FF,FF,FF", &status));
+  GP_CHECK_EQ(status.count, 9);
+  GP_CHECK_EQ(status.bytes[0], 0x00);
+  GP_CHECK_EQ(status.bytes[3], 0xC6);
+  GP_CHECK_EQ(status.bytes[8], 0xFF);
+  GP_CHECK_EQ(status.pattern(), 0x80C4C63Eu);
+  GP_CHECK_EQ(status.position_percent(), 70);
+
+  GP_CHECK(gatepro::GateProStatus::decode("ACK RS:00,a2,e3,40,00", &status));
+  GP_CHECK_EQ(status.pattern(), gatepro::GateProStatus::PATTERN_OPEN);
+
+  GP_CHECK(!gatepro::GateProStatus::decode("ACK RS", &status));
+  GP_CHECK(!gatepro::GateProStatus::decode("ACK RS:00,80", &status));
+  GP_CHECK(!gatepro::GateProStatus::decode("ACK RS:00,80,XX,C6,3E", &status));
+  GP_CHECK(!gatepro::GateProStatus::decode("ACK RS:00;80,C4,C6,3E", &status));
+}
+
+GP_TEST(status_patterns_settle_state_and_publish_raw_bytes) {
+  GateProHarness gate;
+  gate.start();
+  for (int i = 0; i < 3; i++) {
+    gate.feed("ACK RS:00,A2,00,40,00,16,FF,FF,FF\r\n");
+    gate.run_for(50);
+  }
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_CLOSED);
+  GP_CHECK_EQ(gate.position, cover::COVER_CLOSED);
+  GP_CHECK_EQ(gate.status_text.state, "00,A2,00,40,00,16,FF,FF,FF");
+  GP_CHECK_EQ(gate.get_status().bytes[5], 0x16);
+}
+
+GP_TEST(state_estimator_fuses_events_and_patterns) {
+  gatepro::StateEstimator est;
+  est.set_confirmations(2);
+  est.set_timeout(2000);
+
+  // an event is taken at once, an agreeing pattern confirms it
+  est.event(gatepro::END_OPEN, 1000);
+  GP_CHECK_EQ(est.state(), gatepro::END_OPEN);
+  GP_CHECK(!est.confirmed());
+  GP_CHECK_EQ(est.pattern(gatepro::END_OPEN, 1200), gatepro::END_NONE);
+  GP_CHECK(est.confirmed());
+
+  // a lagging pattern is ignored while the event leads
+  est.event(gatepro::END_CLOSED, 5000);
+  GP_CHECK_EQ(est.pattern(gatepro::END_OPEN, 5200), gatepro::END_NONE);
+  GP_CHECK_EQ(est.pattern(gatepro::END_OPEN, 5400), gatepro::END_NONE);
+  GP_CHECK_EQ(est.state(), gatepro::END_CLOSED);
+
+  // after the timeout, a pattern seen often enough wins
+  GP_CHECK_EQ(est.pattern(gatepro::END_OPEN, 7500), gatepro::END_OPEN);
+  GP_CHECK_EQ(est.state(), gatepro::END_OPEN);
+  GP_CHECK(!est.confirmed());
+
+  // a reading without an end position breaks the run
+  gatepro::StateEstimator boot;
+  GP_CHECK_EQ(boot.pattern(gatepro::END_CLOSED, 100), gatepro::END_NONE);
+  GP_CHECK_EQ(boot.pattern(gatepro::END_NONE, 200), gatepro::END_NONE);
+  GP_CHECK_EQ(boot.pattern(gatepro::END_CLOSED, 300), gatepro::END_NONE);
+  GP_CHECK_EQ(boot.pattern(gatepro::END_CLOSED, 400), gatepro::END_CLOSED);
+  GP_CHECK_EQ(boot.readings(), 2);
+}
+
+GP_TEST(lagging_status_does_not_undo_motor_event) {
+  GateProHarness gate;
+  gate.set_state_confirmations(2);
+  gate.set_state_timeout(2000);
+  gate.start();
+  gate.feed("$V1PKF0,17,Opened;src=0001\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_OPEN);
+
+  // the controller closes, the status still reads open for a while
+  gate.feed("$V1PKF0,17,Closed;src=0001\r\n");
+  gate.run_for(100);
+  for (int i = 0; i < 3; i++) {
+    gate.feed("ACK RS:00,A2,E3,40,00,16,FF,FF,FF\r\n");
+    gate.run_for(200);
+  }
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_CLOSED);
+  GP_CHECK_EQ(gate.position, cover::COVER_CLOSED);
+}
+
+GP_TEST(lost_motor_event_falls_back_to_status) {
+  GateProHarness gate;
+  gate.set_state_confirmations(2);
+  gate.set_state_timeout(2000);
+  gate.start();
+  gate.feed("$V1PKF0,17,Closed;src=0001\r\n");
+  gate.run_for(3000);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_CLOSED);
+
+  // opened by hand, the Opening/Opened events were lost
+  gate.feed("ACK RS:00,A2,E3,40,00,16,FF,FF,FF\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_CLOSED);
+  gate.feed("ACK RS:00,A2,E3,40,00,16,FF,FF,FF\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_OPEN);
+  GP_CHECK_EQ(gate.position, cover::COVER_OPEN);
+}
+
+GP_TEST(pattern_table_counts_confidence) {
+  gatepro::PatternTable table;
+  const uint32_t sig = 0xA2010000;
+  // entries that are not looked up yet are not worth saving
+  for (int i = 0; i < gatepro::PatternTable::MIN_CONFIDENCE - 1; i++)
+    GP_CHECK(!table.teach(sig, gatepro::END_CLOSED));
+  GP_CHECK_EQ(table.lookup(sig), gatepro::END_NONE);
+  GP_CHECK(table.teach(sig, gatepro::END_CLOSED));
+  GP_CHECK_EQ(table.lookup(sig), gatepro::END_CLOSED);
+  GP_CHECK_EQ(table.learned(), 1u);
+
+  // saturates, then stops changing
+  for (int i = 0; i < 20; i++)
+    table.teach(sig, gatepro::END_CLOSED);
+  GP_CHECK(!table.teach(sig, gatepro::END_CLOSED));
+
+  // a signature also seen at a stopped gate loses its confidence
+  gatepro::PatternTable mixed;
+  const uint32_t mid = 0xA2800000;
+  for (int i = 0; i < 3; i++)
+    mixed.teach(mid, gatepro::END_OPEN);
+  GP_CHECK_EQ(mixed.lookup(mid), gatepro::END_OPEN);
+  GP_CHECK(mixed.teach(mid, gatepro::END_NONE));
+  GP_CHECK_EQ(mixed.lookup(mid), gatepro::END_NONE);
+  // but a stopped gate never takes a slot of its own
+  gatepro::PatternTable stops;
+  for (uint32_t s = 0; s < 64; s++)
+    GP_CHECK(!stops.teach(0x80000000 | (s << 16), gatepro::END_NONE));
+  for (size_t i = 0; i < gatepro::PatternTable::SLOTS; i++)
+    GP_CHECK_EQ(stops.entries()[i].confidence, 0);
+
+  // learned only from a status that holds still after an event
+  gatepro::PatternTable learner;
+  for (int round = 0; round < gatepro::PatternTable::MIN_CONFIDENCE; round++) {
+    uint32_t t = round * 20000;
+    learner.event(gatepro::END_OPEN, true, t);
+    learner.observe(0x80C48000, t + 200);
+    learner.observe(0xA2E20000, t + 400);
+    learner.observe(0xA2E20000, t + 600);
+    learner.observe(0xA2E20000, t + 800);  // one lesson per event
+  }
+  GP_CHECK_EQ(learner.lookup(0xA2E20000), gatepro::END_OPEN);
+  GP_CHECK_EQ(learner.lookup(0x80C48000), gatepro::END_NONE);
+  learner.event(gatepro::END_NONE, false, 100000);
+  learner.observe(0xA2E20000, 100200);
+  learner.observe(0xA2E20000, 100400);
+  GP_CHECK_EQ(learner.lookup(0xA2E20000), gatepro::END_OPEN);
+  learner.event(gatepro::END_CLOSED, true, 200000);
+  learner.observe(0xA2E20000, 211000);
+  learner.observe(0xA2E20000, 211200);
+  GP_CHECK_EQ(learner.lookup(0xA2E20000), gatepro::END_OPEN);
+
+  // restored entries must sit in their own slot and name an end state
+  gatepro::PatternTable restored;
+  gatepro::PatternEntry saved[gatepro::PatternTable::SLOTS];
+  memcpy(saved, table.entries(), sizeof(saved));
+  for (auto &entry : saved)
+    entry.reserved[0] = entry.reserved[1] = 0xFF;
+  restored.load(saved);
+  GP_CHECK_EQ(restored.lookup(sig), gatepro::END_CLOSED);
+  // the cache is compared byte for byte, stale reserved bytes must not leak
+  for (size_t i = 0; i < gatepro::PatternTable::SLOTS; i++) {
+    GP_CHECK_EQ(restored.entries()[i].reserved[0], 0);
+    GP_CHECK_EQ(restored.entries()[i].reserved[1], 0);
+  }
+  for (auto &entry : saved)
+    entry.state = gatepro::END_NONE;
+  restored.load(saved);
+  GP_CHECK_EQ(restored.learned(), 0u);
+}
+
+// Plays a controller that answers the status polls the gate sends, and
+// nothing else
+struct StatusResponder {
+  GateProHarness &gate;
+  std::string status;
+  size_t polls{0};
+
+  void run(uint32_t ms) {
+    gatepro::testing::run_gates({&this->gate}, ms, [this] {
+      for (const auto &frame : this->gate.take_tx_frames()) {
+        if (frame.rfind("RS;", 0) == 0) {
+          this->polls++;
+          this->gate.feed("ACK RS:" + this->status + "\r\n");
+        }
+      }
+    });
+  }
+};
+
+static const uint32_t LEARN_TIME = gatepro::PatternTable::LEARN_WINDOW + 1000;
+
+// Closes the gate on a controller whose closed status is not the built-in one
+static void close_with_other_pattern(StatusResponder &controller) {
+  controller.status = "00,80,C4,C6,3E,16,FF,FF,FF";
+  controller.gate.feed("$V1PKF0,17,Closing;src=0001\r\n");
+  controller.run(3000);
+  controller.status = "00,A2,01,40,00,16,FF,FF,FF";
+  controller.gate.feed("$V1PKF0,17,Closed;src=0001\r\n");
+  controller.run(LEARN_TIME);
+}
+
+GP_TEST(status_patterns_are_learned_and_kept) {
+  {
+    GateProHarness gate;
+    StatusResponder controller{gate, "00,A2,01,40,00,16,FF,FF,FF"};
+    gate.start();
+    controller.run(LEARN_TIME);
+    for (int i = 0; i < gatepro::PatternTable::MIN_CONFIDENCE; i++)
+      close_with_other_pattern(controller);
+    GP_CHECK_EQ(gate.patterns_.lookup(0xA2010000), gatepro::END_CLOSED);
+    GP_CHECK_EQ(host::preference_writes(), 1u);
+
+    // the fast polls for learning end with the learn window
+    controller.polls = 0;
+    controller.run(30000);
+    GP_CHECK_EQ(controller.polls, 0u);
+
+    // stops in between, each at another position, neither write the flash
+    // nor push the learned pattern out
+    for (int pos = 10; pos < 90; pos += 7) {
+      char status[32];
+      snprintf(status, sizeof(status), "00,A2,11,%02X,00,16,FF,FF,FF", 0x80 | pos);
+      controller.status = "00,80,C4,C6,3E,16,FF,FF,FF";
+      gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+      controller.run(1000);
+      controller.status = status;
+      gate.feed("$V1PKF0,17,Stopped;src=0001\r\n");
+      controller.run(LEARN_TIME);
+    }
+    GP_CHECK_EQ(host::preference_writes(), 1u);
+    GP_CHECK_EQ(gate.patterns_.lookup(0xA2010000), gatepro::END_CLOSED);
+
+    // further confirmations are saved at most once per interval
+    close_with_other_pattern(controller);
+    GP_CHECK_EQ(host::preference_writes(), 1u);
+  }
+
+  // after a reboot the learned pattern settles the state without an event,
+  // also where the position bits differ
+  GateProHarness gate(500, true);
+  StatusResponder controller{gate, "00,A2,01,00,00,16,FF,FF,FF"};
+  gate.start();
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_UNKNOWN);
+  // the second reading comes with the next idle poll
+  controller.run(2000);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_UNKNOWN);
+  controller.run(60000);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_CLOSED);
+  GP_CHECK_EQ(gate.position, cover::COVER_CLOSED);
+}
+
+GP_TEST(built_in_patterns_end_the_learn_window) {
+  GateProHarness gate;
+  StatusResponder controller{gate, "00,A2,00,40,00,16,FF,FF,FF"};
+  gate.start();
+  controller.run(2000);
+  controller.status = "00,80,C4,C6,3E,16,FF,FF,FF";
+  gate.feed("$V1PKF0,17,Closing;src=0001\r\n");
+  controller.run(3000);
+  controller.status = "00,A2,00,40,00,16,FF,FF,FF";
+  gate.feed("$V1PKF0,17,Closed;src=0001\r\n");
+  controller.run(1000);
+  controller.polls = 0;
+  controller.run(LEARN_TIME);
+  GP_CHECK_EQ(controller.polls, 0u);
+  GP_CHECK_EQ(gate.patterns_.learned(), 0u);
+}
+
+GP_TEST(params_decoder_accepts_hex_and_rejects_malformed) {
+  gatepro::GateProParams params;
+  GP_CHECK(gatepro::GateProParams::decode("ACK RP,1:1,0,0,3,2,2,A,0,0,3,0,0,3,0,0,1,0", &params));
+  GP_CHECK(params.complete());
+  GP_CHECK_EQ(params[6], 0x0A);
+
+  GP_CHECK(gatepro::GateProParams::decode("ACK RP,1:1,0,0,3,2,2,1E,0,0,3,0,0,3,0,0,1,0", &params));
+  GP_CHECK_EQ(params[6], 0x1E);
+
+  // missing fields stay unknown
+  GP_CHECK(gatepro::GateProParams::decode("ACK RP,1:1,,0,3", &params));
+  GP_CHECK(params.has(0));
+  GP_CHECK(!params.has(1));
+  GP_CHECK(params.has(3));
+  GP_CHECK(!params.complete());
+
+  // rejected frames leave the previous values alone
+  GP_CHECK(!gatepro::GateProParams::decode("ACK RP,1:1,0,0,3,2,2,0,0,0,3,0,0,3,0,0,1,0,0", &params));
+  GP_CHECK(!gatepro::GateProParams::decode("ACK RP,1:1,0,X,3", &params));
+  GP_CHECK(!gatepro::GateProParams::decode("ACK RP,1:1,0,123", &params));
+  GP_CHECK(!gatepro::GateProParams::decode("ACK RP", &params));
+  GP_CHECK_EQ(params.valid, 0x0Du);
+}
+
+static const char *FULL_PARAMS = "ACK RP,1:1,0,0,3,2,2,C,0,0,3,0,0,3,0,0,1,0\r\n";
+
+static size_t count_prefix(const std::vector<std::string> &frames, const std::string &prefix) {
+  size_t n = 0;
+  for (auto &f : frames) {
+    if (f.rfind(prefix, 0) == 0)
+      n++;
+  }
+  return n;
+}
+
+GP_TEST(param_changes_are_batched_into_one_write) {
+  GateProHarness gate;
+  gate.start();
+  gate.run_for(200);
+  gate.feed(FULL_PARAMS);
+  gate.run_for(2000);
+  gate.take_tx_frames();
+
+  // several entities restored at once
+  gate.speed_number.publish_state(4);
+  gate.permalock.publish_state(false);
+  gate.speed_number.publish_state(2);
+  gate.run_for(400);
+  auto frames = gate.take_tx_frames();
+  GP_CHECK_EQ(count_prefix(frames, "RP,"), 1u);
+  GP_CHECK_EQ(count_prefix(frames, "WP,"), 0u);
+
+  gate.feed(FULL_PARAMS);
+  gate.run_for(400);
+  frames = gate.take_tx_frames();
+  GP_CHECK_EQ(count_prefix(frames, "WP,"), 1u);
+  GP_CHECK(contains(frames, "WP,1:1,0,0,2,2,2,C,0,0,3,0,0,3,0,0,0,0"));
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_VERIFYING);
+
+  // the verify RP waits for the gate to take the WP
+  gate.run_for(400);
+  GP_CHECK_EQ(count_prefix(gate.take_tx_frames(), "RP,"), 0u);
+  gate.feed("ACK WP\r\n");
+  gate.run_for(400);
+  GP_CHECK_EQ(count_prefix(gate.take_tx_frames(), "RP,"), 1u);
+  gate.feed("ACK RP,1:1,0,0,2,2,2,C,0,0,3,0,0,3,0,0,0,0\r\n");
+  gate.run_for(2000);
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_IDLE);
+  GP_CHECK_EQ(count_prefix(gate.take_tx_frames(), "WP,"), 0u);
+  GP_CHECK_EQ(gate.speed_number.state, 2.0f);
+}
+
+GP_TEST(param_transaction_recovers_from_lost_frames) {
+  GateProHarness gate;
+  gate.set_tx_queue_size(3);
+  gate.start();
+  gate.run_for(200);
+  gate.feed(FULL_PARAMS);
+  gate.feed("ACK RS:00,A2,00,40,00,16,FF,FF,FF\r\n");
+  gate.run_for(5000);
+  gate.take_tx_frames();
+
+  // the RP finds the queue full: the transaction gives up instead of hanging
+  gate.speed_number.publish_state(4);
+  host::advance_ms(300);
+  gate.tx_queue.push({gatepro::GATEPRO_CMD_DEVINFO});
+  gate.tx_queue.push({gatepro::GATEPRO_CMD_READ_LEARN_STATUS});
+  gate.tx_queue.push({gatepro::GATEPRO_CMD_READ_FUNCTION});
+  gate.tick();
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_IDLE);
+  gate.run_for(5000);
+  gate.take_tx_frames();
+
+  // the next change starts a new one, whose RP is then lost
+  gate.speed_number.publish_state(4);
+  gate.run_for(260);
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_READING);
+  gate.tx_queue.clear();
+  gate.run_for(GateProHarness::PARAM_TXN_TIMEOUT);
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_IDLE);
+  gate.take_tx_frames();
+
+  // an RP answer that arrives before the verify RP went out is not the verify
+  gate.speed_number.publish_state(4);
+  gate.run_for(400);
+  GP_CHECK_EQ(count_prefix(gate.take_tx_frames(), "RP,"), 1u);
+  gate.feed(FULL_PARAMS);
+  gate.feed(FULL_PARAMS);
+  gate.tick();
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_VERIFYING);
+  gate.run_for(400);
+  GP_CHECK(contains(gate.take_tx_frames(), "WP,1:1,0,0,4,2,2,C,0,0,3,0,0,3,0,0,1,0"));
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_VERIFYING);
+  gate.feed("ACK WP\r\n");
+  gate.run_for(400);
+  GP_CHECK_EQ(count_prefix(gate.take_tx_frames(), "RP,"), 1u);
+  gate.feed("ACK RP,1:1,0,0,4,2,2,C,0,0,3,0,0,3,0,0,1,0\r\n");
+  gate.run_for(100);
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_IDLE);
+
+  // a lost ACK WP leaves nothing to verify, the timeout ends the transaction
+  gate.speed_number.publish_state(2);
+  gate.run_for(400);
+  gate.feed(FULL_PARAMS);
+  gate.run_for(400);
+  GP_CHECK(contains(gate.take_tx_frames(), "WP,1:1,0,0,2,2,2,C,0,0,3,0,0,3,0,0,1,0"));
+  gate.run_for(GateProHarness::PARAM_TXN_TIMEOUT);
+  GP_CHECK_EQ(count_prefix(gate.take_tx_frames(), "RP,"), 0u);
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_IDLE);
+}
+
+GP_TEST(param_write_needs_every_field) {
+  GateProHarness gate;
+  gate.start();
+  gate.run_for(200);
+  gate.feed("ACK RP,1:1,0,0,3\r\n");
+  gate.run_for(2000);
+  gate.take_tx_frames();
+
+  gate.speed_number.publish_state(2);
+  gate.run_for(400);
+  GP_CHECK_EQ(count_prefix(gate.take_tx_frames(), "RP,"), 1u);
+  gate.feed("ACK RP,1:1,0,0,3\r\n");
+  gate.run_for(500);
+  GP_CHECK_EQ(count_prefix(gate.take_tx_frames(), "WP,"), 0u);
+  GP_CHECK_EQ(gate.param_txn_, gatepro::PARAM_TXN_IDLE);
+  // the entity goes back to what the gate reported
+  GP_CHECK_EQ(gate.speed_number.state, 3.0f);
+}
+
+GP_TEST(params_and_devinfo_are_cached_across_reboots) {
+  {
+    GateProHarness gate;
+    gate.start();
+    gate.run_for(200);
+    gate.feed(FULL_PARAMS);
+    gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+    gate.run_for(500);
+    GP_CHECK_EQ(host::preference_writes(), 2u);
+
+    // unchanged answers do not touch the flash
+    gate.queue_gatepro_cmd(gatepro::GATEPRO_CMD_READ_PARAMS);
+    gate.run_for(200);
+    gate.feed(FULL_PARAMS);
+    gate.run_for(200);
+    GP_CHECK_EQ(host::preference_writes(), 2u);
+  }
+
+  GateProHarness gate(500, true);
+  gate.start();
+  // published before anything was received
+  GP_CHECK(gate.params.complete());
+  GP_CHECK_EQ(gate.speed_number.state, 3.0f);
+  GP_CHECK(gate.permalock.state);
+  GP_CHECK_EQ(gate.devinfo_text.state, "P500BU,PS21053C,V01");
+
+  // the boot RP still checks them
+  gate.run_for(200);
+  GP_CHECK(contains(gate.take_tx_frames(), "RP,1:;src=P00287D7"));
+  gate.feed("ACK RP,1:1,0,0,4,2,2,C,0,0,3,0,0,3,0,0,1,0\r\n");
+  gate.run_for(200);
+  GP_CHECK_EQ(gate.speed_number.state, 4.0f);
+  GP_CHECK_EQ(host::preference_writes(), 3u);
+}
+
+GP_TEST(motion_model_learns_speed_and_bounds_extrapolation) {
+  gatepro::MotionModel model;
+  model.start(1, 0.0f, 1000);
+  GP_CHECK_NEAR(model.estimate(1500), 0.0f, 1e-6f);  // speed still unknown
+
+  model.sample(0.05f, 1500);
+  GP_CHECK_NEAR(model.velocity(1), 0.10f, 1e-4f);
+  GP_CHECK_NEAR(model.estimate(2000), 0.10f, 1e-4f);
+  model.sample(0.10f, 2000);
+  GP_CHECK_NEAR(model.estimate(2250), 0.125f, 1e-4f);
+  // capped in distance and time past the last sample
+  GP_CHECK_NEAR(model.estimate(4000), 0.20f, 1e-4f);
+  GP_CHECK_NEAR(model.estimate(60000), 0.20f, 1e-4f);
+
+  // a slower sample pulls the estimate towards it
+  model.sample(0.12f, 2500);
+  GP_CHECK(model.velocity(1) < 0.10f);
+  GP_CHECK(model.velocity(1) > 0.04f);
+  GP_CHECK_NEAR(model.velocity(-1), 0.0f, 1e-6f);
+
+  model.stop(0.12f, 2600);
+  GP_CHECK(!model.moving());
+  GP_CHECK_NEAR(model.estimate(5000), 0.12f, 1e-6f);
+
+  // closing never extrapolates below fully closed
+  model.start(-1, 0.02f, 10000);
+  model.sample(0.01f, 10200);
+  GP_CHECK_NEAR(model.estimate(11000), 0.0f, 1e-6f);
+}
+
+GP_TEST(position_is_interpolated_between_polls) {
+  GateProHarness gate;
+  gate.set_moving_poll_interval(2000);
+  gate.start();
+  gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+  gate.run_for(1000);
+  gate.feed("ACK RS:00,80,C4,8A,3E,16,FF,FF,FF\r\n");  // 10%
+  gate.run_for(1000);
+  gate.feed("ACK RS:00,80,C4,94,3E,16,FF,FF,FF\r\n");  // 20%
+  gate.run_for(20);
+  GP_CHECK_NEAR(gate.position, 0.20f, 0.011f);
+
+  int published = gate.publish_count;
+  gate.run_for(500);
+  // moving on at the learned 10%/s without a new sample
+  GP_CHECK_NEAR(gate.position, 0.25f, 0.011f);
+  GP_CHECK(gate.publish_count > published);
+}
+
+GP_TEST(stop_planner_leads_target_and_learns_coast) {
+  gatepro::StopPlanner planner;
+  planner.arm(0.50f, 1);
+  // 0.1/s with 100ms latency and 300ms default coast: stop 4% early
+  GP_CHECK(!planner.should_stop(0.45f, 0.10f, 100));
+  GP_CHECK(planner.should_stop(0.46f, 0.10f, 100));
+  // unknown speed falls back to a fixed window
+  GP_CHECK(!planner.should_stop(0.44f, 0.0f, 100));
+  GP_CHECK(planner.should_stop(0.46f, 0.0f, 100));
+
+  planner.fired(0.10f);
+  GP_CHECK(!planner.armed());
+  GP_CHECK(!planner.landing());
+  planner.motor_stopped();
+  GP_CHECK(planner.landing());
+  // 2% past the target is 200ms of extra coast, half of it is learned
+  GP_CHECK(planner.landed(0.52f));
+  GP_CHECK_EQ(planner.coast(1), 400);
+  GP_CHECK_EQ(planner.coast(-1), gatepro::StopPlanner::DEFAULT_COAST);
+
+  // closing, short of the target
+  planner.arm(0.30f, -1);
+  planner.fired(0.20f);
+  planner.motor_stopped();
+  GP_CHECK(planner.landed(0.34f));
+  GP_CHECK_EQ(planner.coast(-1), 200);
+}
+
+// Minimal gate simulation: answers RS with its position and coasts for
+// `coast_ms` after STOP before reporting Stopped.
+struct SimGate {
+  GateProHarness &gate;
+  float position{0.0f};
+  float speed{0.10f};  // per second
+  int8_t direction{0};
+  uint32_t coast_ms{800};
+  int64_t stop_at{-1};
+
+  void step(uint32_t ms) {
+    for (uint32_t t = 0; t < ms; t += 10) {
+      gate.run_for(10, 10);
+      uint32_t now = millis();
+      for (auto &f : gate.take_tx_frames()) {
+        if (f.rfind("FULL OPEN", 0) == 0) {
+          direction = 1;
+          gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+        } else if (f.rfind("FULL CLOSE", 0) == 0) {
+          direction = -1;
+          gate.feed("$V1PKF0,17,Closing;src=0001\r\n");
+        } else if (f.rfind("STOP", 0) == 0 && direction != 0) {
+          stop_at = now + coast_ms;
+        } else if (f.rfind("RS", 0) == 0) {
+          char frame[64];
+          int pct = (int) std::lround(position * 100);
+          snprintf(frame, sizeof(frame), "ACK RS:00,80,C4,%02X,3E,16,FF,FF,FF\r\n", 0x80 | pct);
+          gate.feed(frame);
+        }
+      }
+      if (direction != 0) {
+        position = std::clamp(position + direction * speed * 0.010f, 0.0f, 1.0f);
+        if (stop_at >= 0 && int64_t(now) >= stop_at) {
+          direction = 0;
+          stop_at = -1;
+          gate.feed("$V1PKF0,17,Stopped;src=0001\r\n");
+        }
+      }
+    }
+  }
+};
+
+GP_TEST(partial_moves_land_on_target) {
+  GateProHarness gate;
+  gate.start();
+  SimGate sim{gate};
+  sim.step(2000);
+
+  float targets[] = {0.40f, 0.10f, 0.50f, 0.20f, 0.60f};
+  float first_error = 0.0f;
+  float last_error = 0.0f;
+  for (float target : targets) {
+    gate.make_call().set_position(target).perform();
+    sim.step(15000);
+    float error = std::fabs(sim.position - target);
+    if (target == targets[0])
+      first_error = error;
+    last_error = error;
+    GP_CHECK_NEAR(gate.position, sim.position, 0.011f);
+  }
+  // the default coast guess lands within a few percent, learning gets closer
+  GP_CHECK(first_error < 0.06f);
+  GP_CHECK(last_error < 0.02f);
+  GP_CHECK(gate.stop_planner_.coast(1) > gatepro::StopPlanner::DEFAULT_COAST);
+}
+
+GP_TEST(idle_state_is_not_republished) {
+  GateProHarness gate;
+  gate.start();
+  gate.run_for(1000);
+  int published = gate.publish_count;
+  gate.run_for(60000);
+  GP_CHECK_EQ(gate.publish_count, published);
+
+  gate.set_heartbeat_interval(10000);
+  gate.run_for(60000);
+  GP_CHECK_NEAR(gate.publish_count - published, 6, 1);
+}
+
+GP_TEST(moving_publishes_are_rate_limited) {
+  GateProHarness gate;
+  gate.set_moving_publish_interval(1000);
+  gate.start();
+  gate.run_for(1000);
+
+  int published = gate.publish_count;
+  gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+  gate.run_for(20);
+  // operation changes go out right away
+  GP_CHECK_EQ(gate.publish_count, published + 1);
+
+  // a new position every 100ms
+  for (int pct = 1; pct <= 30; pct++) {
+    char frame[64];
+    snprintf(frame, sizeof(frame), "ACK RS:00,80,C4,%02X,3E,16,FF,FF,FF\r\n", 0x80 | pct);
+    gate.feed(frame);
+    gate.run_for(100);
+  }
+  GP_CHECK(gate.publish_count - published <= 5);
+  GP_CHECK(gate.publish_count - published >= 3);
+
+  gate.feed("$V1PKF0,17,Stopped;src=0001\r\n");
+  gate.run_for(20);
+  GP_CHECK_EQ(gate.current_operation, cover::COVER_OPERATION_IDLE);
+  GP_CHECK_NEAR(gate.position, 0.30f, 0.001f);
+  int stopped = gate.publish_count;
+  gate.run_for(5000);
+  GP_CHECK(gate.publish_count <= stopped + 1);  // the settled position at most
+}
+
+GP_TEST(trace_ring_keeps_latest_records) {
+  gatepro::TraceRing ring;
+  for (uint32_t i = 0; i < gatepro::TraceRing::CAPACITY + 10; i++)
+    ring.record(i * 100, gatepro::TRACE_RX, i, "ACK RS:00,80,C4");
+  GP_CHECK_EQ(ring.size(), gatepro::TraceRing::CAPACITY);
+  GP_CHECK_EQ(ring[0].arg, 10);
+  GP_CHECK_EQ(ring[0].time_us, 1000u);
+  GP_CHECK_EQ(ring[ring.size() - 1].arg, gatepro::TraceRing::CAPACITY + 9);
+  GP_CHECK_EQ(ring[0].len, gatepro::TraceRecord::DATA_SIZE);
+  GP_CHECK_EQ(std::string(ring[0].data, ring[0].len), "ACK RS:0");
+  ring.dump("test");
+  ring.clear();
+  GP_CHECK_EQ(ring.size(), 0u);
+}
+
+GP_TEST(bus_traffic_is_traced) {
+  GateProHarness gate;
+  gate.start();
+  gate.run_for(200);
+  gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+  gate.run_for(50);
+
+  bool queued = false, tx = false, rx = false, motor = false;
+  for (size_t i = 0; i < gate.trace_ring_.size(); i++) {
+    const auto &rec = gate.trace_ring_[i];
+    std::string data(rec.data, rec.len);
+    queued |= rec.event == gatepro::TRACE_QUEUED && data == "RS;src=P";
+    tx |= rec.event == gatepro::TRACE_TX && data == "RS;src=P";
+    rx |= rec.event == gatepro::TRACE_RX && data == "$V1PKF0,";
+    motor |= rec.event == gatepro::TRACE_MOTOR && rec.arg == gatepro::STATE_OPENING;
+  }
+  GP_CHECK(queued);
+  GP_CHECK(tx);
+  GP_CHECK(rx);
+  GP_CHECK(motor);
+}
+
+GP_TEST(latency_histogram_percentiles) {
+  gatepro::LatencyHistogram histogram;
+  GP_CHECK_EQ(histogram.percentile(50), 0u);
+  for (int i = 0; i < 90; i++)
+    histogram.add(8);
+  for (int i = 0; i < 10; i++)
+    histogram.add(300);
+  GP_CHECK_EQ(histogram.count(), 100u);
+  GP_CHECK_EQ(histogram.percentile(50), 10u);
+  GP_CHECK_EQ(histogram.percentile(90), 10u);
+  GP_CHECK_EQ(histogram.percentile(95), 300u);  // capped at the largest sample
+  GP_CHECK_EQ(histogram.max(), 300u);
+  histogram.add(100000);
+  GP_CHECK_EQ(histogram.bucket(gatepro::LatencyHistogram::BUCKETS - 1), 1u);
+  histogram.clear();
+  GP_CHECK_EQ(histogram.count(), 0u);
+}
+
+GP_TEST(protocol_metrics_are_counted_and_published) {
+  GateProHarness gate;
+  sensor::Sensor frames_in, parse_failures, ack_latency, motion_latency;
+  gate.set_counter_sensor(gatepro::COUNTER_FRAMES_IN, &frames_in);
+  gate.set_counter_sensor(gatepro::COUNTER_PARSE_FAILURES, &parse_failures);
+  gate.set_latency_sensor(gatepro::LATENCY_ACK, &ack_latency);
+  gate.set_latency_sensor(gatepro::LATENCY_MOTION, &motion_latency);
+  gate.start();
+  gate.run_for(100);
+  GP_CHECK(gate.take_tx_frames().size() >= 1);  // the boot RS
+  gate.run_for(30);
+  gate.feed("ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n");
+  gate.feed("ACK RS:zz\r\n");
+  gate.run_for(50);
+
+  gate.make_call().set_command_open().perform();
+  gate.run_for(200);
+  gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+  gate.run_for(600);
+
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_FRAMES_IN), 3u);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_PARSE_FAILURES), 1u);
+  GP_CHECK(gate.get_counter(gatepro::COUNTER_FRAMES_OUT) >= 2);
+  GP_CHECK(gate.get_latency(gatepro::LATENCY_COMMAND).count() >= 2);
+  GP_CHECK_EQ(gate.get_latency(gatepro::LATENCY_ACK).count(), 1u);
+  GP_CHECK_EQ(gate.get_latency(gatepro::LATENCY_MOTION).count(), 1u);
+  GP_CHECK(gate.get_latency(gatepro::LATENCY_MOTION).max() <= 200);
+  GP_CHECK_EQ(frames_in.state, 3.0f);
+  GP_CHECK_EQ(parse_failures.state, 1.0f);
+  GP_CHECK(ack_latency.has_state());
+  GP_CHECK(motion_latency.has_state());
+  gate.dump_config();
+}
+
+GP_TEST(rx_overflow_and_queue_drops_are_counted) {
+  GateProHarness gate;
+  gate.start();
+  gate.feed(std::string(gatepro::RxFramer::DEFAULT_CAPACITY + 10, 'x'));
+  gate.run_for(50);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_RX_OVERFLOWS), 1u);
+
+  // one of each command is more than the queue can hold
+  for (uint8_t cmd = gatepro::GATEPRO_CMD_OPEN; cmd <= gatepro::GATEPRO_CMD_READ_FUNCTION; cmd++)
+    gate.tx_queue.push({(gatepro::GateProCmd) cmd});
+  GP_CHECK(gate.get_counter(gatepro::COUNTER_QUEUE_DROPS) >= 1);
+}
+
+GP_TEST(burst_is_dispatched_within_one_loop) {
+  GateProHarness gate(60000);
+  gate.start();
+  std::string burst;
+  for (int i = 0; i < 10; i++)
+    burst += "ACK RS:00,80,C4,C6,3E,16,FF,FF,FF\r\n$V1PKF0,17,Opening;src=0001\r\n";
+  burst += "$V1PKF0,17,Stopped;src=0001\r\n";
+  gate.feed(burst);
+  uint32_t before = gate.get_counter(gatepro::COUNTER_FRAMES_IN);
+  gate.run_for(16);
+  // more than the RX ring holds at once, all of it handled in a single loop()
+  GP_CHECK(burst.size() > gatepro::RxFramer::DEFAULT_CAPACITY);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_FRAMES_IN) - before, 21u);
+  GP_CHECK_EQ(gate.gate_state_, gatepro::STATE_STOPPED);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_LOOP_OVERRUNS), 0u);
+}
+
+GP_TEST(loop_budget_defers_frames_and_counts_overruns) {
+  GateProHarness gate(60000);
+  sensor::Sensor backlog;
+  gate.set_rx_backlog_sensor(&backlog);
+  gate.set_loop_budget(1000);
+  gate.start();
+  // every DEVINFO frame costs 400us of (simulated) CPU time
+  gate.devinfo_text.add_on_state_callback([](const std::string &) { host::advance_us(400); });
+  for (int i = 0; i < 6; i++)
+    gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  uint32_t before = gate.get_counter(gatepro::COUNTER_FRAMES_IN);
+
+  // three frames fit into 1000us, the third one overruns the budget
+  gate.run_for(16);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_FRAMES_IN) - before, 3u);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_LOOP_OVERRUNS), 1u);
+  // the backlog peak is published by update() and starts over
+  GP_CHECK(backlog.state >= 3 * 38.0f);
+  GP_CHECK_EQ(gate.get_rx_backlog_peak(), 0u);
+  gate.run_for(16);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_FRAMES_IN) - before, 6u);
+
+  // a single frame over budget is still handled
+  gate.set_loop_budget(0);
+  gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  gate.feed("ACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  gate.run_for(16);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_FRAMES_IN) - before, 7u);
+}
+
+GP_TEST(buffer_capacities_are_configurable) {
+  GateProHarness gate;
+  gate.set_tx_queue_size(4);
+  gate.set_rx_buffer_size(128);
+  gate.start();
+  GP_CHECK_EQ(gate.tx_queue.capacity(), 4u);
+  GP_CHECK_EQ(gate.rx_framer_.capacity(), 128u);
+
+  gate.tx_queue.clear();
+  for (auto cmd : {gatepro::GATEPRO_CMD_READ_STATUS, gatepro::GATEPRO_CMD_READ_PARAMS, gatepro::GATEPRO_CMD_DEVINFO,
+                   gatepro::GATEPRO_CMD_READ_LEARN_STATUS, gatepro::GATEPRO_CMD_READ_FUNCTION})
+    gate.queue_gatepro_cmd(cmd);
+  GP_CHECK_EQ(gate.tx_queue.size(), 4u);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_QUEUE_DROPS), 1u);
+
+  gate.feed(std::string(200, 'x'));
+  gate.run_for(50);
+  GP_CHECK_EQ(gate.get_counter(gatepro::COUNTER_RX_OVERFLOWS), 1u);
+  gate.feed("\r\nACK READ DEVINFO:P500BU,PS21053C,V01\r\n");
+  gate.run_for(50);
+  GP_CHECK_EQ(gate.devinfo_text.state, "P500BU,PS21053C,V01");
+}
+
+GP_TEST(uart_capture_keeps_whole_records) {
+  gatepro::UartCapture capture;
+  capture.record(0, gatepro::CAPTURE_RX, reinterpret_cast<const uint8_t *>("x"), 1);
+  GP_CHECK_EQ(capture.size(), 0u);  // disabled until init()
+
+  capture.init(256);
+  std::string frame = "$V1PKF0,17,Closing;src=0001\r\n";
+  for (uint32_t i = 0; i < 20; i++)
+    capture.record(i * 1000, gatepro::CAPTURE_RX, reinterpret_cast<const uint8_t *>(frame.data()), frame.size());
+  GP_CHECK(capture.bytes_used() <= capture.capacity());
+  auto records = gatepro::testing::records_from(capture);
+  GP_CHECK_EQ(records.size(), capture.size());
+  GP_CHECK_EQ(records.back().time_us, 19000u);
+  bool intact = true;
+  for (auto &rec : records)
+    intact &= rec.data == frame;
+  GP_CHECK(intact);
+
+  // long writes are split, the dump line round-trips
+  std::string status(100, 'A');
+  capture.record(20000, gatepro::CAPTURE_TX, reinterpret_cast<const uint8_t *>(status.data()), status.size());
+  records = gatepro::testing::records_from(capture);
+  GP_CHECK_EQ(records.back().data.size(), status.size() - gatepro::CaptureRecord::MAX_DATA);
+  char line[gatepro::UartCapture::MAX_LINE];
+  gatepro::CaptureRecord rec{123456, gatepro::CAPTURE_TX, 4, reinterpret_cast<const uint8_t *>("RS\r\n")};
+  GP_CHECK(gatepro::UartCapture::format(rec, line, sizeof(line)) > 0);
+  GP_CHECK_EQ(std::string(line), "CAP 123456 T 52530D0A");
+  gatepro::testing::ReplayRecord parsed;
+  GP_CHECK(gatepro::testing::parse_capture_line(std::string("[I][gatepro:1]: ") + line, &parsed));
+  GP_CHECK_EQ(parsed.time_us, 123456u);
+  GP_CHECK_EQ(parsed.direction, gatepro::CAPTURE_TX);
+  GP_CHECK_EQ(parsed.data, "RS\r\n");
+}
+
+GP_TEST(captured_traffic_replays_deterministically) {
+  GateProHarness gate;
+  gate.set_capture_size(4096);
+  gate.start();
+  gate.run_for(200);
+  gate.feed("ACK RS:00,80,C4,80,3E,16,FF,FF,FF\r\n");
+  gate.run_for(100);
+  gate.make_call().set_command_open().perform();
+  gate.run_for(100);
+  gate.feed("$V1PKF0,17,Opening;src=0001\r\n");
+  for (int pct = 10; pct <= 90; pct += 20) {
+    gate.run_for(500);
+    char frame[64];
+    snprintf(frame, sizeof(frame), "ACK RS:00,80,C4,%02X,3E,16,FF,FF,FF\r\n", 0x80 | pct);
+    gate.feed(frame);
+  }
+  gate.run_for(300);
+  gate.feed("$V1PKF0,17,Opened;src=0001\r\n");
+  gate.run_for(300);
+
+  // through the textual dump, as it would come out of the device log
+  std::stringstream dump;
+  gate.get_capture().for_each([&](const gatepro::CaptureRecord &rec) {
+    char line[gatepro::UartCapture::MAX_LINE];
+    gatepro::UartCapture::format(rec, line, sizeof(line));
+    dump << line << "\n";
+  });
+  auto records = gatepro::testing::parse_capture(dump);
+  GP_CHECK_EQ(records.size(), gate.get_capture().size());
+
+  auto first = gatepro::testing::replay_capture(records);
+  auto second = gatepro::testing::replay_capture(records);
+  GP_CHECK(!first.transcript.empty());
+  GP_CHECK(first.transcript == second.transcript);
+  auto captured = gatepro::testing::capture_frames(records, gatepro::CAPTURE_TX);
+  // only RX is replayed, the OPEN came from control() in the captured run
+  GP_CHECK(contains(captured, "FULL OPEN;src=P00287D7"));
+  GP_CHECK(!contains(first.tx_frames, "FULL OPEN;src=P00287D7"));
+  std::string last_state;
+  for (auto &line : first.transcript) {
+    if (line.find(" STATE ") != std::string::npos)
+      last_state = line;
+  }
+  GP_CHECK(last_state.find("state=2") != std::string::npos);  // STATE_OPEN
+}
+
+// The controller's answer to a request, RS answers report `percent`
+static std::string answer_to(const std::string &request, int percent) {
+  if (request.rfind("RS;", 0) == 0) {
+    char frame[64];
+    snprintf(frame, sizeof(frame), "ACK RS:00,80,C4,%02X,3E,16,FF,FF,FF\r\n", 0x80 | percent);
+    return frame;
+  }
+  if (request.rfind("RP,", 0) == 0)
+    return "ACK RP,1:1,0,0,3,2,2,0,0,0,3,0,0,3,0,0,1,0\r\n";
+  if (request.rfind("READ DEVINFO", 0) == 0)
+    return "ACK READ DEVINFO:P500BU,PS21053C,V01\r\n";
+  if (request.rfind("READ LEARN STATUS", 0) == 0)
+    return "ACK LEARN STATUS:SYSTEM LEARN COMPLETE,0\r\n";
+  return "";
+}
+
+GP_TEST(shared_uart_routes_acks_to_the_waiting_gate) {
+  gatepro::GateProBus bus;
+  GateProHarness east, west;
+  east.set_source("P0000EA5");
+  west.set_source("P000035E");
+  west.set_uart_parent(&east.uart);
+  east.set_bus(&bus);
+  west.set_bus(&bus);
+  GP_CHECK(bus.shared(&west));
+  GP_CHECK(bus.reads(&east));
+  GP_CHECK(!bus.reads(&west));
+  east.start();
+  west.start();
+  // neither gate has an event source, both take the event
+  east.feed("$V1PKF0,17,Opening;src=0001\r\n");
+
+  // The controllers answer 50ms after a request. The answers carry no source,
+  // the RS position tells whose request they answer.
+  std::vector<std::string> sent;
+  std::string answer;
+  uint32_t answer_at = 0;
+  bool overlapped = false;
+  gatepro::testing::run_gates({&east, &west}, 3000, [&] {
+    for (auto &frame : east.take_tx_frames()) {
+      sent.push_back(frame);
+      overlapped |= !answer.empty();
+      bool from_east = frame.find("src=P0000EA5") != std::string::npos;
+      answer = answer_to(frame, from_east ? 20 : 70);
+      answer_at = millis() + 50;
+    }
+    if (!answer.empty() && int32_t(millis() - answer_at) >= 0) {
+      east.feed(answer);
+      answer.clear();
+    }
+  });
+
+  // one request on the wire at a time, and every request was answered
+  GP_CHECK(!overlapped);
+  for (auto *source : {"P0000EA5", "P000035E"}) {
+    for (auto *request : {"RP,1:", "READ DEVINFO", "READ LEARN STATUS"})
+      GP_CHECK_EQ(count(sent, std::string(request) + ";src=" + source), 1u);
+  }
+  GP_CHECK(east.params.complete());
+  GP_CHECK(west.params.complete());
+  GP_CHECK_EQ(east.devinfo_text.state, "P500BU,PS21053C,V01");
+  GP_CHECK_EQ(west.devinfo_text.state, "P500BU,PS21053C,V01");
+  GP_CHECK_NEAR(east.position, 0.20f, 0.011f);
+  GP_CHECK_NEAR(west.position, 0.70f, 0.011f);
+}
+
+GP_TEST(shared_uart_routes_motor_events_by_source) {
+  gatepro::GateProBus bus;
+  GateProHarness east, west;
+  west.set_uart_parent(&east.uart);
+  east.set_bus(&bus);
+  west.set_bus(&bus);
+  east.set_event_source("0001");
+  west.set_event_source("0002");
+  east.start();
+  west.start();
+
+  east.feed("$V1PKF0,17,Opening;src=0002\r\n");
+  gatepro::testing::run_gates({&east, &west}, 100);
+  GP_CHECK_EQ(west.gate_state_, gatepro::STATE_OPENING);
+  GP_CHECK(east.gate_state_ != gatepro::STATE_OPENING);
+
+  east.feed("$V1PKF0,17,Closing;src=0001\r\n");
+  gatepro::testing::run_gates({&east, &west}, 100);
+  GP_CHECK_EQ(east.gate_state_, gatepro::STATE_CLOSING);
+  GP_CHECK_EQ(west.gate_state_, gatepro::STATE_OPENING);
+
+  // unknown sources go to gates without an event source, here there are none
+  east.feed("$V1PKF0,17,Stopped;src=0003\r\n");
+  gatepro::testing::run_gates({&east, &west}, 100);
+  GP_CHECK_EQ(east.gate_state_, gatepro::STATE_CLOSING);
+  GP_CHECK_EQ(west.gate_state_, gatepro::STATE_OPENING);
+}
+
+GP_TEST(bus_spreads_status_polls) {
+  gatepro::GateProBus bus;
+  bus.set_poll_gap(250);
+  GateProHarness east, west;
+  east.set_source("P0000EA5");
+  west.set_source("P000035E");
+  east.set_bus(&bus);
+  west.set_bus(&bus);
+  GP_CHECK(!bus.shared(&east));
+  east.start();
+  west.start();
+  // both gates moving, each wants a poll every 100ms
+  for (auto *gate : {&east, &west}) {
+    gate->set_moving_poll_interval(100);
+    gate->feed("$V1PKF0,17,Opening;src=0001\r\n");
+  }
+
+  // separate UARTs, the controllers answer right away
+  uint32_t counting_from = millis() + 1000;
+  size_t polls[2] = {0, 0};
+  gatepro::testing::run_gates({&east, &west}, 6000, [&] {
+    GateProHarness *gates[2] = {&east, &west};
+    for (int i = 0; i < 2; i++) {
+      for (auto &frame : gates[i]->take_tx_frames()) {
+        if (frame.rfind("RS;", 0) == 0 && millis() >= counting_from)
+          polls[i]++;
+        gates[i]->feed(answer_to(frame, 20));
+      }
+    }
+  });
+  // one poll per gap on the whole hub, taken in turns
+  GP_CHECK(polls[0] + polls[1] <= 5000 / 250 + 1);
+  GP_CHECK(polls[0] + polls[1] >= 5000 / 256 - 1);
+  GP_CHECK(polls[0] >= 9 && polls[1] >= 9);
+}
+
+int main() { return gatepro_test::run_all(); }